@@ -164,9 +164,7 @@ fragment Digitsequence: DIGIT ('\''? DIGIT)*;
 
 fragment NON_DIGIT: [a-zA-Z_];
 
-fragment CHINESE_DIGIT:
-	'\u4E00' ..'\u9FA5'
-	| '\uF900' ..'\uFA2D';
+fragment NON_ASCII: [\u0080-\u{10FFFF}];
 
 fragment DIGIT: [0-9];
 
@@ -203,7 +201,7 @@ ArrarIdentifier: Identifier '[]';
 templateIdentifier: Identifier '<' templateparameterlist '>';
 templateparameterlist: Identifier (',' Identifier)*;
 
-fragment IDENTIFIER_NON_DIGIT: NON_DIGIT | CHINESE_DIGIT;
+fragment IDENTIFIER_NON_DIGIT: NON_DIGIT | NON_ASCII;
 
 SemiColon: ';';
 Comma: ',';
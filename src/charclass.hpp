@@ -0,0 +1,114 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace cd::script
+{
+// class bits of every byte, independent of the process locale
+namespace charclass
+{
+using class_t = uint16_t;
+inline constexpr class_t Digit = 1 << 0;
+inline constexpr class_t XDigit = 1 << 1;
+inline constexpr class_t BDigit = 1 << 2;
+inline constexpr class_t ODigit = 1 << 3;
+inline constexpr class_t Alpha = 1 << 4;
+inline constexpr class_t Underscore = 1 << 5;
+inline constexpr class_t Punct = 1 << 6;
+inline constexpr class_t Disallowed = 1 << 7;
+inline constexpr class_t Blank = 1 << 8;
+inline constexpr class_t LineBreak = 1 << 9;
+// bytes of utf-8 sequences, identifiers take them as letters. 0xFF never occurs in utf-8
+// and doubles as the lexer's EOF
+inline constexpr class_t NonAscii = 1 << 10;
+
+inline constexpr class_t IdHead = Alpha | Underscore | NonAscii;
+inline constexpr class_t IdBody = Alpha | Underscore | Digit | NonAscii;
+
+constexpr std::array<class_t, 256> BuildTable()
+{
+    std::array<class_t, 256> table{};
+    for (int ch = '0'; ch <= '9'; ++ch)
+    {
+        table[ch] |= Digit | XDigit;
+    }
+    for (int ch = '0'; ch <= '7'; ++ch)
+    {
+        table[ch] |= ODigit;
+    }
+    table['0'] |= BDigit;
+    table['1'] |= BDigit;
+    for (int ch = 'a'; ch <= 'z'; ++ch)
+    {
+        table[ch] |= Alpha;
+        table[ch - 'a' + 'A'] |= Alpha;
+    }
+    for (int ch = 'a'; ch <= 'f'; ++ch)
+    {
+        table[ch] |= XDigit;
+        table[ch - 'a' + 'A'] |= XDigit;
+    }
+    for (char ch : std::string_view(R"#(!"#$%&'()*+,-./:;<=>?@[\]^_`{|}~)#"))
+    {
+        table[static_cast<unsigned char>(ch)] |= Punct;
+    }
+    for (char ch : std::string_view(R"#($()\`@)#"))
+    {
+        table[static_cast<unsigned char>(ch)] |= Disallowed;
+    }
+    table['_'] |= Underscore;
+    for (char ch : std::string_view(" \t\v\f"))
+    {
+        table[static_cast<unsigned char>(ch)] |= Blank;
+    }
+    table[0] |= Blank;
+    table['\r'] |= LineBreak;
+    table['\n'] |= LineBreak;
+    for (int ch = 0x80; ch < 0xFF; ++ch)
+    {
+        table[ch] |= NonAscii;
+    }
+    return table;
+}
+
+inline constexpr std::array<class_t, 256> Table = BuildTable();
+
+// value of a hex digit, 16 for anything else
+constexpr std::array<uint8_t, 256> BuildDigitValue()
+{
+    std::array<uint8_t, 256> table{};
+    for (auto &value : table)
+    {
+        value = 16;
+    }
+    for (int ch = '0'; ch <= '9'; ++ch)
+    {
+        table[ch] = static_cast<uint8_t>(ch - '0');
+    }
+    for (int ch = 'a'; ch <= 'f'; ++ch)
+    {
+        table[ch] = static_cast<uint8_t>(ch - 'a' + 10);
+        table[ch - 'a' + 'A'] = static_cast<uint8_t>(ch - 'a' + 10);
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> DigitValue = BuildDigitValue();
+
+constexpr class_t Of(char ch)
+{
+    return Table[static_cast<unsigned char>(ch)];
+}
+
+constexpr bool Is(char ch, class_t mask)
+{
+    return (Of(ch) & mask) != 0;
+}
+}  // namespace charclass
+}  // namespace cd::script
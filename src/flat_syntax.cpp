@@ -0,0 +1,92 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "flat_syntax.hpp"
+#include <vector>
+#include "visitor.hpp"
+
+namespace cd::script
+{
+// appends nodes in post-order without recursion, visiting a node only schedules its children
+// on the work stack, roots of finished subtrees wait on the roots stack for their parent
+class FlatSyntaxBuilder : public Visitor
+{
+  public:
+    FlatSyntaxTree tree;
+
+    void Build(Syntax *root)
+    {
+        std::any data;
+        work.push_back({root, nullptr});
+        while (!work.empty())
+        {
+            auto item = work.back();
+            work.pop_back();
+            if (item.expand)
+            {
+                item.expand->Visit(this, data);
+                continue;
+            }
+            auto right = roots.back();
+            roots.pop_back();
+            auto left = roots.back();
+            roots.pop_back();
+            auto &op = item.combine->op;
+            Append({SyntaxKind::BinaryExpression, static_cast<uint16_t>(op.type), op.offset, left, right});
+        }
+    }
+
+    void Visit(BinaryExpression *syntax, std::any &) override
+    {
+        // the left operand is on top, so it comes out first
+        work.push_back({nullptr, syntax});
+        work.push_back({syntax->right.get(), nullptr});
+        work.push_back({syntax->left.get(), nullptr});
+    }
+
+    void Visit(LiteralValue *syntax, std::any &) override
+    {
+        auto &value = syntax->value;
+        uint32_t payload = 0;
+        if (value.type == Token::Number)
+        {
+            payload = static_cast<uint32_t>(tree.numbers.size());
+            tree.numbers.push_back(value.number());
+        }
+        else if (value.type == Token::String)
+        {
+            payload = static_cast<uint32_t>(tree.texts.size());
+            tree.texts.push_back(value.str());
+        }
+        Append({SyntaxKind::LiteralValue, static_cast<uint16_t>(value.type), value.offset, payload, 0});
+    }
+
+  private:
+    // a node to visit, or a BinaryExpression whose operands are done
+    struct Work
+    {
+        Syntax *expand;
+        BinaryExpression *combine;
+    };
+    std::vector<Work> work;
+    std::vector<uint32_t> roots;
+
+    void Append(const FlatSyntaxTree::Node &node)
+    {
+        roots.push_back(static_cast<uint32_t>(tree.nodes.size()));
+        tree.nodes.push_back(node);
+    }
+};
+
+FlatSyntaxTree FlatSyntaxTree::Flatten(Syntax *root)
+{
+    FlatSyntaxBuilder builder;
+    if (root)
+    {
+        builder.Build(root);
+    }
+    return std::move(builder.tree);
+}
+}  // namespace cd::script
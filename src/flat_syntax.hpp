@@ -0,0 +1,75 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <string_view>
+#include <vector>
+#include "syntax.hpp"
+#include "token.hpp"
+
+namespace cd::script
+{
+enum class SyntaxKind : uint8_t
+{
+    LiteralValue,
+    BinaryExpression,
+};
+
+// a syntax tree laid out in one node array, children come before their parent and the root is
+// the last node, so a pass in index order sees operands before their operator.
+// literal payloads live in side tables as in TokenStream, texts view what the tokens viewed
+struct FlatSyntaxTree
+{
+    struct Node
+    {
+        SyntaxKind kind;
+        // operator of BinaryExpression, token type of LiteralValue
+        uint16_t type;
+        // offset of the operator or literal token
+        uint32_t offset;
+        // operand node indices of BinaryExpression, for LiteralValue first indexes numbers
+        // for Number and texts for String
+        uint32_t first;
+        uint32_t second;
+    };
+    static_assert(sizeof(Node) == 16, "Node should stay four words");
+
+    std::vector<Node> nodes;
+    std::vector<NumberValue> numbers;
+    std::vector<std::string_view> texts;
+
+    size_t size() const
+    {
+        return nodes.size();
+    }
+
+    uint32_t root() const
+    {
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    // token of a LiteralValue node
+    Token Literal(uint32_t index) const
+    {
+        const auto &node = nodes[index];
+        Token token;
+        token.type = node.type;
+        token.offset = node.offset;
+        if (node.type == Token::Number)
+        {
+            token.value.number = numbers[node.first];
+        }
+        else if (node.type == Token::String)
+        {
+            auto text = texts[node.first];
+            token.value.text = {text.data(), static_cast<uint32_t>(text.size()), 0};
+        }
+        return token;
+    }
+
+    // copies the tree under root, which may be empty
+    static FlatSyntaxTree Flatten(Syntax *root);
+};
+}  // namespace cd::script
@@ -0,0 +1,141 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <array>
+#include <string_view>
+#include "token.hpp"
+
+namespace cd::script
+{
+struct KeyWord
+{
+    std::string_view word;
+    token_t type;
+};
+
+inline constexpr KeyWord KeyWords[] = {
+    {"null", Token::Null},
+    {"true", Token::True},
+    {"false", Token::False},
+    {"if", Token::If},
+    {"else", Token::Else},
+    {"for", Token::For},
+    {"while", Token::While},
+    {"in", Token::In},
+    {"break", Token::Break},
+    {"continue", Token::Continue},
+    {"return", Token::Return},
+    {"fun", Token::Function},
+    {"try", Token::Try},
+    {"catch", Token::Catch},
+    {"throw", Token::Throw},
+    {"class", Token::Class},
+    {"interface", Token::Interface},
+    {"is", Token::Is},
+    {"object", Token::Object},
+    {"this", Token::This},
+    {"super", Token::Super},
+    {"any", Token::Any},
+};
+
+// perfect hash over KeyWords keyed by first character, last character and length,
+// the seed is searched at compile time so editing KeyWords needs no manual tuning
+namespace keyword
+{
+inline constexpr size_t TableSize = 64;
+
+constexpr size_t FindMinLength()
+{
+    size_t length = KeyWords[0].word.size();
+    for (const auto &kw : KeyWords)
+    {
+        length = kw.word.size() < length ? kw.word.size() : length;
+    }
+    return length;
+}
+
+constexpr size_t FindMaxLength()
+{
+    size_t length = 0;
+    for (const auto &kw : KeyWords)
+    {
+        length = kw.word.size() > length ? kw.word.size() : length;
+    }
+    return length;
+}
+
+// bounds a word must be within to be looked up, constants so every identifier only compares twice
+inline constexpr size_t MinLength = FindMinLength();
+inline constexpr size_t MaxLength = FindMaxLength();
+
+constexpr size_t Hash(std::string_view word, uint32_t seed)
+{
+    auto first = static_cast<uint32_t>(static_cast<unsigned char>(word.front()));
+    auto last = static_cast<uint32_t>(static_cast<unsigned char>(word.back()));
+    return (first * seed + last + static_cast<uint32_t>(word.size()) * 7) & (TableSize - 1);
+}
+
+constexpr bool IsPerfect(uint32_t seed)
+{
+    std::array<bool, TableSize> used{};
+    for (const auto &kw : KeyWords)
+    {
+        auto index = Hash(kw.word, seed);
+        if (used[index])
+        {
+            return false;
+        }
+        used[index] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t FindSeed()
+{
+    for (uint32_t seed = 1; seed < 4096; ++seed)
+    {
+        if (IsPerfect(seed))
+        {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+inline constexpr uint32_t Seed = FindSeed();
+static_assert(Seed != 0, "no perfect hash seed for KeyWords, enlarge TableSize");
+
+constexpr std::array<KeyWord, TableSize> BuildTable()
+{
+    std::array<KeyWord, TableSize> table{};
+    for (auto &slot : table)
+    {
+        slot.type = Token::Identifier;
+    }
+    for (const auto &kw : KeyWords)
+    {
+        table[Hash(kw.word, Seed)] = kw;
+    }
+    return table;
+}
+
+inline constexpr std::array<KeyWord, TableSize> Table = BuildTable();
+}  // namespace keyword
+
+// returns Token::Identifier when word is not a keyword
+constexpr token_t GetKeyWord(std::string_view word)
+{
+    if (word.size() < keyword::MinLength || word.size() > keyword::MaxLength)
+    {
+        return Token::Identifier;
+    }
+    const auto &slot = keyword::Table[keyword::Hash(word, keyword::Seed)];
+    return slot.word == word ? slot.type : static_cast<token_t>(Token::Identifier);
+}
+
+static_assert(GetKeyWord("interface") == Token::Interface);
+static_assert(GetKeyWord("interfaces") == Token::Identifier);
+}  // namespace cd::script
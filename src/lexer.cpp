@@ -5,15 +5,23 @@
 
 #include "lexer.hpp"
 #include <algorithm>
-#include <cctype>
 #include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <functional>
 #include <iostream>
-#include <unordered_map>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include "charclass.hpp"
+#include "keyword.hpp"
+#include "mapped_file.hpp"
+#include "operator.hpp"
+#include "scan.hpp"
 #include "utils.hpp"
 
 namespace cd::script
 {
-static const std::string disallowed = R"#($()\`@)#";
 static const size_t BIT8 = 8;
 static const size_t BIT16 = 16;
 static const size_t BIT32 = 32;
@@ -24,17 +32,13 @@ enum class ERadix : int
     Hex = 16
 };
 
-inline bool isbdigit(char ch) { return ch == '0' || ch == '1'; }
-inline bool isodigit(char ch) { return ch >= '0' && ch <= '8'; }
-inline bool isdigit(char ch) { return std::isdigit(static_cast<unsigned char>(ch)); }
-inline bool isxdigit(char ch) { return std::isxdigit(static_cast<unsigned char>(ch)); }
-inline bool isalpha(char ch) { return std::isalpha(static_cast<unsigned char>(ch)); }
-inline bool isalnum(char ch) { return std::isalnum(static_cast<unsigned char>(ch)); }
-inline bool ispunct(char ch) { return std::ispunct(static_cast<unsigned char>(ch)); }
-inline bool isidhead(char ch) { return isalpha(ch) || ch == '_'; }
-inline bool isidbody(char ch) { return isalnum(ch) || ch == '_'; }
-inline bool isallowedpunct(char ch) { return ispunct(ch) && disallowed.find(ch) == std::string::npos; }
-inline bool isdelimiter(char ch) { return isalnum(ch) || isallowedpunct(ch); }
+inline bool isbdigit(char ch) { return charclass::Is(ch, charclass::BDigit); }
+inline bool isodigit(char ch) { return charclass::Is(ch, charclass::ODigit); }
+inline bool isdigit(char ch) { return charclass::Is(ch, charclass::Digit); }
+inline bool isxdigit(char ch) { return charclass::Is(ch, charclass::XDigit); }
+inline bool isidhead(char ch) { return charclass::Is(ch, charclass::IdHead); }
+inline bool isidbody(char ch) { return charclass::Is(ch, charclass::IdBody); }
+inline bool isdelimiter(char ch) { return (charclass::Of(ch) & (charclass::Alpha | charclass::Underscore | charclass::Digit | charclass::Punct)) != 0 && !charclass::Is(ch, charclass::Disallowed); }
 inline bool isexponent(char ch) { return ch == 'E' || ch == 'e'; }
 inline bool isxexponent(char ch) { return ch == 'P' || ch == 'p'; }
 inline bool isunsigned(char ch) { return ch == 'U' || ch == 'u'; }
@@ -42,56 +46,256 @@ inline bool issigned(char ch) { return ch == 'I' || ch == 'i'; }
 inline bool isfloat(char ch) { return ch == 'F' || ch == 'f'; }
 inline bool isdigit(char ch, ERadix radix) { return (radix == ERadix::Dec) ? isdigit(ch) : isxdigit(ch); }
 inline bool isexponent(char ch, ERadix radix) { return (radix == ERadix::Dec) ? isexponent(ch) : isxexponent(ch); }
+inline uint32_t digitvalue(char ch) { return charclass::DigitValue[static_cast<unsigned char>(ch)]; }
 
-static std::unordered_map<std::string, token_t> KeyWords = {
-    {"null", Token::Null},
-    {"true", Token::True},
-    {"false", Token::False},
-    {"if", Token::If},
-    {"else", Token::Else},
-    {"for", Token::For},
-    {"while", Token::While},
-    {"in", Token::In},
-    {"break", Token::Break},
-    {"continue", Token::Continue},
-    {"return", Token::Return},
-    {"fun", Token::Function},
-    {"try", Token::Try},
-    {"catch", Token::Catch},
-    {"throw", Token::Throw},
-    {"class", Token::Class},
-    {"interface", Token::Interface},
-    {"is", Token::Is},
-    {"object", Token::Object},
-    {"this", Token::This},
-    {"super", Token::Super},
-    {"any", Token::Any},
+// thrown when a streaming lexer reaches the end of its window with input left,
+// the interrupted token is lexed again after the window is refilled
+struct NeedInput
+{
+};
+
+// token offsets are 32 bits, larger sources are refused instead of wrapping them
+static const size_t MaxSourceSize = std::numeric_limits<uint32_t>::max();
+
+static void CheckSourceSize(size_t size)
+{
+    if (size > MaxSourceSize)
+    {
+        throw Exception("source too large: more than ", MaxSourceSize, " bytes");
+    }
+}
+
+// sources are only split into chunks of at least this many bytes
+static const size_t MinChunkSize = 64 * 1024;
+
+// utf-8 is validated this far ahead of the lexer at a time
+static const size_t ValidateBlockSize = 64 * 1024;
+
+static void AppendUtf8(std::string &text, uint32_t point)
+{
+    if (point < 0x80)
+    {
+        text.push_back(static_cast<char>(point));
+    }
+    else if (point < 0x800)
+    {
+        text.push_back(static_cast<char>(0xC0 | (point >> 6)));
+        text.push_back(static_cast<char>(0x80 | (point & 0x3F)));
+    }
+    else if (point < 0x10000)
+    {
+        text.push_back(static_cast<char>(0xE0 | (point >> 12)));
+        text.push_back(static_cast<char>(0x80 | ((point >> 6) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | (point & 0x3F)));
+    }
+    else
+    {
+        text.push_back(static_cast<char>(0xF0 | (point >> 18)));
+        text.push_back(static_cast<char>(0x80 | ((point >> 12) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | ((point >> 6) & 0x3F)));
+        text.push_back(static_cast<char>(0x80 | (point & 0x3F)));
+    }
+}
+
+// tokens a worker lexed from a chunk start, checked against the real stream afterwards
+struct Chunk
+{
+    uint32_t begin = 0;
+    uint32_t stop = 0;
+    TokenStream tokens;
+    // holds the escaped texts of tokens until they are copied to the lexer arena
+    std::shared_ptr<std::pmr::memory_resource> arena;
+    // start of the first token at or after stop, or of the token the chunk failed on
+    uint32_t next = 0;
+    bool newline = false;
+    bool failed = false;
+    // chunk symbol to lexer symbol, filled while stitching
+    std::vector<symbol_t> symbols;
 };
 
 class LexerImpl : public Lexer
 {
   private:
-    std::istream &code;
+    std::string storage;
+    MappedFile mapping;
+    const char *source;
+    const char *cursor;
+    const char *end;
     char current;
-    size_t line;
-    size_t column;
     std::string buffer;
+    std::shared_ptr<std::pmr::memory_resource> arena;
+    std::shared_ptr<SymbolTable> symbols;
+    unsigned threads;
+    CommentMode comments;
+    ErrorMode errors;
+    std::vector<Diagnostic> diagnostics;
+    // an error was reported in the token being lexed
+    bool reported = false;
+    // a line break was passed since the last token that is not a comment
+    bool newline = false;
+    const char *token_begin = nullptr;
+    // [.., validated) is known to be utf-8 apart from the first bad sequence found there, if any
+    const char *validated = nullptr;
+    const char *invalid = nullptr;
+    std::unique_ptr<LineIndex> lines;
+    // set on chunk workers whose errors are discarded or re-lexed, skips building the line index
+    bool speculative = false;
+    // streaming lexers keep a window of the input in storage, base is the input offset of source,
+    // input is reset once it is exhausted
+    bool streaming = false;
+    std::istream *input = nullptr;
+    size_t chunk_size = 0;
+    size_t base = 0;
+    SourceLocation window_location;
 
   public:
-    LexerImpl(std::istream &_code)
-        : code(_code), current(EOF), line(1), column(0), buffer("")
+    LexerImpl(std::string_view _code, const LexerOptions &options)
+        : storage(), mapping(), source(_code.data()), cursor(source), end(_code.data() + _code.size()), current(EOF), buffer(""), arena(GetArena(options)), symbols(GetSymbols(options)), threads(options.threads), comments(options.comments), errors(options.errors)
+    {
+        validated = source;
+    }
+
+    LexerImpl(std::string &&_code, const LexerOptions &options)
+        : storage(std::move(_code)), mapping(), source(storage.data()), cursor(source), end(storage.data() + storage.size()), current(EOF), buffer(""), arena(GetArena(options)), symbols(GetSymbols(options)), threads(options.threads), comments(options.comments), errors(options.errors)
+    {
+        validated = source;
+    }
+
+    LexerImpl(std::istream &_input, size_t _chunk_size, const LexerOptions &options)
+        : storage(), mapping(), source(storage.data()), cursor(source), end(source), current(EOF), buffer(""), arena(GetArena(options)), symbols(GetSymbols(options)), threads(options.threads), comments(options.comments), errors(options.errors), streaming(true), input(&_input), chunk_size(std::max<size_t>(_chunk_size, 1))
     {
+        validated = source;
+    }
+
+    LexerImpl(MappedFile &&_mapping, const LexerOptions &options)
+        : storage(), mapping(std::move(_mapping)), source(mapping.view().data()), cursor(source), end(mapping.view().data() + mapping.view().size()), current(EOF), buffer(""), arena(GetArena(options)), symbols(GetSymbols(options)), threads(options.threads), comments(options.comments), errors(options.errors)
+    {
+        validated = source;
     }
     ~LexerImpl()
     {
     }
 
+    static std::shared_ptr<std::pmr::memory_resource> GetArena(const LexerOptions &options)
+    {
+        return options.arena ? options.arena : std::make_shared<std::pmr::monotonic_buffer_resource>();
+    }
+
+    std::shared_ptr<SymbolTable> GetSymbols(const LexerOptions &options) const
+    {
+        return options.symbols ? options.symbols : std::make_shared<SymbolTable>(arena);
+    }
+
+    SymbolTable &GetSymbolTable() override
+    {
+        return *symbols;
+    }
+
+    const std::vector<Diagnostic> &GetDiagnostics() const override
+    {
+        return diagnostics;
+    }
+
+    // throws in ErrorMode::Throw, otherwise records the first error of the current token,
+    // which the caller then finishes as an Error token
+    template <typename... Args>
+    void Report(Args &&... args)
+    {
+        ReportAt(Position(), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void ReportAt(const char *where, Args &&... args)
+    {
+        if (errors == ErrorMode::Throw)
+        {
+            throw Exception(std::forward<Args>(args)...);
+        }
+        if (!reported)
+        {
+            diagnostics.push_back({static_cast<uint32_t>(base + (where - source)), Exception(std::forward<Args>(args)...).what()});
+            reported = true;
+        }
+    }
+
+    inline Token ErrorToken()
+    {
+        reported = false;
+        // only the first error of a token is reported
+        if (OverInvalidUtf8())
+        {
+            invalid = nullptr;
+            validated = Position();
+        }
+        return NormalToken(Token::Error);
+    }
+
+    // skips what is left of a malformed number
+    Token MalformedNumber()
+    {
+        while (isidbody(current) || current == '.')
+        {
+            current = Next();
+        }
+        return ErrorToken();
+    }
+
+    // skips the rest of a malformed string up to its closing quote or the end of the line
+    Token MalformedString(char quote)
+    {
+        while (current != quote && current != '\r' && current != '\n' && current != EOF)
+        {
+            current = Next();
+        }
+        if (current == quote)
+        {
+            current = Next();
+        }
+        return ErrorToken();
+    }
+
+    SourceLocation GetLocation(uint32_t offset) override
+    {
+        uint32_t relative = offset - static_cast<uint32_t>(base);
+        if (relative > static_cast<size_t>(end - source))
+        {
+            throw Exception("offset ", offset, " is no longer buffered");
+        }
+        if (!lines)
+        {
+            lines = std::make_unique<LineIndex>(std::string_view(source, end - source));
+        }
+        auto location = lines->Locate(relative);
+        if (location.line == 1)
+        {
+            location.column += window_location.column;
+        }
+        location.line += window_location.line - 1;
+        return location;
+    }
+
+    // location of current, only computed when reporting an error
+    SourceLocation Here()
+    {
+        return Here(Position());
+    }
+
+    SourceLocation Here(const char *where)
+    {
+        if (speculative)
+        {
+            return {};
+        }
+        return GetLocation(static_cast<uint32_t>(base + (where - source)));
+    }
+
     inline Token NormalToken(token_t type)
     {
         Token token;
         token.type = type;
-        token.line = line;
-        token.column = column;
+        token.newline = newline;
+        token.offset = static_cast<uint32_t>(base + (token_begin - source));
+        newline = newline && type == Token::Comment;
         return token;
     }
 
@@ -102,231 +306,702 @@ class LexerImpl : public Lexer
 
     virtual Token GetToken() override
     {
-        if (current == EOF)
+        if (!streaming)
         {
-            current = Next();
+            return Scan();
         }
+        return ScanStreaming();
+    }
 
-        while (current != EOF)
+    // the window and the escape buffer move on with the next token, text is kept in the arena
+    // so tokens held by a parser or a stream stay readable
+    Token ScanStreaming()
+    {
+        while (true)
         {
-            switch (current)
+            size_t count = diagnostics.size();
+            try
             {
-            case ' ':
-            case '\f':
-            case '\t':
-            case '\v':
-            case '\0':
+                Token token = Scan();
+                if (token.type == Token::String || token.type == Token::Comment)
+                {
+                    token.value.text.data = Store(token.str()).data();
+                }
+                return token;
+            }
+            catch (const NeedInput &)
             {
-                current = Next();
-                break;
+                diagnostics.resize(count);
+                reported = false;
+                Refill();
             }
-            case '\r':
-            case '\n':
+        }
+    }
+
+    // drops the window before the interrupted token and appends the next chunk of input
+    void Refill()
+    {
+        const char *restart = token_begin ? token_begin : source;
+        const char *keep = restart;
+        // a line break pair is never split, so lines are counted the same on both sides
+        while (keep > source && keep < end && (keep[-1] == '\r' || keep[-1] == '\n') && (keep[0] == '\r' || keep[0] == '\n') && keep[-1] != keep[0])
+        {
+            --keep;
+        }
+        size_t dropped = keep - source;
+        if (dropped > 0)
+        {
+            auto location = LineIndex(std::string_view(source, dropped)).Locate(static_cast<uint32_t>(dropped));
+            window_location.column = location.line == 1 ? window_location.column + location.column : location.column;
+            window_location.line += location.line - 1;
+            storage.erase(0, dropped);
+            base += dropped;
+        }
+        // a token filling the whole window doubles it, so long tokens are not rescanned for every chunk
+        size_t size = storage.size();
+        size_t wanted = dropped == 0 ? std::max(chunk_size, size) : chunk_size;
+        storage.resize(size + wanted);
+        input->read(storage.data() + size, static_cast<std::streamsize>(wanted));
+        storage.resize(size + static_cast<size_t>(input->gcount()));
+        if (input->gcount() == 0)
+        {
+            input = nullptr;
+        }
+        size_t restart_offset = restart - source - dropped;
+        source = storage.data();
+        end = source + storage.size();
+        cursor = source + restart_offset;
+        token_begin = cursor;
+        current = EOF;
+        validated = cursor;
+        invalid = nullptr;
+        lines.reset();
+    }
+
+    inline void Underflow()
+    {
+        if (input)
+        {
+            throw NeedInput();
+        }
+    }
+
+    TokenStream Tokenize() override
+    {
+        size_t left = end - Position();
+        size_t count = std::min<size_t>(threads, left / MinChunkSize);
+        if (count > 1 && !streaming)
+        {
+            // chunk workers do not validate, an invalid sequence is reported by lexing serially
+            Validate(end);
+            if (!invalid)
             {
-                NewLine();
-                break;
+                return TokenizeChunks(count);
             }
-            case '\'':
-            case '"':
+        }
+        TokenStream stream;
+        stream.symbols = symbols;
+        stream.arena = arena;
+        if (streaming)
+        {
+            while (true)
             {
-                return SingleLineStringToken();
+                Token token = ScanStreaming();
+                stream.Push(token);
+                if (token.type == Token::EndOfFile)
+                {
+                    return stream;
+                }
             }
-            case '/':
+        }
+        stream.source = std::string_view(source, end - source);
+        // code averages more than four bytes a token, so the arrays are rarely regrown
+        size_t estimate = left / 4 + 1;
+        stream.types.reserve(estimate);
+        stream.offsets.reserve(estimate);
+        stream.newlines.reserve(estimate);
+        stream.payloads.reserve(estimate);
+        // pages of the reserved room are only touched once used
+        stream.numbers.reserve(estimate / 2);
+        stream.texts.reserve(estimate / 2);
+        while (true)
+        {
+            Token token = Scan();
+            stream.Push(token);
+            if (token.type == Token::EndOfFile)
             {
-                auto next = Next();
-                if (next == '/')
+                return stream;
+            }
+        }
+    }
+
+    // lexes tokens starting in [chunk.begin, chunk.stop) as if no token crossed chunk.begin
+    void LexChunk(Chunk &chunk, bool line_start)
+    {
+        cursor = source + chunk.begin;
+        current = EOF;
+        newline = line_start;
+        chunk.tokens.symbols = symbols;
+        try
+        {
+            while (true)
+            {
+                Token token = Scan();
+                if (token.offset >= chunk.stop)
                 {
-                    current = Next();
-                    return SingleLineCommentToken();
+                    chunk.next = token.offset;
+                    chunk.newline = token.newline;
+                    break;
                 }
-                else if (next == '*')
+                chunk.tokens.Push(token);
+                if (token.type == Token::EndOfFile)
                 {
-                    current = Next();
-                    return MultiLineCommentToken();
+                    chunk.next = token.offset;
+                    chunk.newline = token.newline;
+                    break;
                 }
-                else if (next == '=')
+            }
+        }
+        catch (const Exception &)
+        {
+            chunk.next = static_cast<uint32_t>(token_begin - source);
+            chunk.newline = newline;
+            chunk.failed = chunk.next < chunk.stop;
+        }
+        chunk.arena = arena;
+    }
+
+    TokenStream TokenizeChunks(size_t count)
+    {
+        uint32_t size = static_cast<uint32_t>(end - source);
+        uint32_t next = static_cast<uint32_t>(Position() - source);
+        // whether a line break comes before the token at next, chunk tokens before
+        // the first one that meets the real stream may not know
+        bool line_start = newline;
+        // chunks start at line starts where only comments and raw strings can be open
+        std::vector<Chunk> chunks(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto &chunk = chunks[i];
+            if (i == 0)
+            {
+                chunk.begin = next;
+            }
+            else
+            {
+                const char *split = std::max(source + next + (size - next) / count * i, source + chunks[i - 1].begin);
+                split = std::find(split, end, '\n');
+                chunk.begin = static_cast<uint32_t>(split == end ? size : split - source + 1);
+                chunks[i - 1].stop = chunk.begin;
+            }
+        }
+        chunks.back().stop = size + 1;
+
+        std::vector<std::thread> workers;
+        auto lex = [this](Chunk &chunk, bool line_start) {
+            LexerOptions options;
+            options.comments = comments;
+            LexerImpl worker(std::string_view(source, end - source), options);
+            worker.speculative = true;
+            worker.validated = worker.end;
+            worker.LexChunk(chunk, line_start);
+        };
+        for (size_t i = 1; i < count; ++i)
+        {
+            workers.emplace_back(lex, std::ref(chunks[i]), source[chunks[i].begin - 1] == '\n');
+        }
+        lex(chunks[0], line_start);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        TokenStream stream;
+        stream.source = std::string_view(source, size);
+        stream.symbols = symbols;
+        stream.arena = arena;
+        size_t token_count = 0, number_count = 0, text_count = 0;
+        for (auto &chunk : chunks)
+        {
+            token_count += chunk.tokens.size();
+            number_count += chunk.tokens.numbers.size();
+            text_count += chunk.tokens.texts.size();
+        }
+        stream.types.reserve(token_count);
+        stream.offsets.reserve(token_count);
+        stream.newlines.reserve(token_count);
+        stream.payloads.reserve(token_count);
+        stream.numbers.reserve(number_count);
+        stream.texts.reserve(text_count);
+        for (auto &chunk : chunks)
+        {
+            if (next >= chunk.stop)
+            {
+                continue;
+            }
+            // the real token starts meet the chunk ones again after whatever the chunk started inside
+            const auto &offsets = chunk.tokens.offsets;
+            // a comment leaves the newline flag of the tokens after it to the chunk, which may
+            // have lexed the line before out of context, so only other tokens take over
+            auto meets = [&](size_t index) { return index < offsets.size() && offsets[index] == next && chunk.tokens.types[index] != Token::Comment; };
+            size_t index = std::lower_bound(offsets.begin(), offsets.end(), next) - offsets.begin();
+            bool aligned = meets(index);
+            cursor = source + next;
+            current = EOF;
+            newline = line_start;
+            while (true)
+            {
+                if (aligned)
                 {
-                    current = Next();
-                    return NormalToken(Token::DivideEqual);
+                    Adopt(stream, chunk, index, line_start);
+                    index = offsets.size();
+                    next = chunk.next;
+                    line_start = chunk.newline;
+                    if (!chunk.failed)
+                    {
+                        break;
+                    }
+                    // the error the chunk stopped at is real, lex that token here to report it
+                    cursor = source + next;
+                    current = EOF;
+                    newline = line_start;
                 }
-                else
+                size_t count = diagnostics.size();
+                Token token = Scan();
+                next = token.offset;
+                line_start = token.newline;
+                if (next >= chunk.stop)
                 {
-                    current = next;
-                    return NormalToken('/');
+                    // the next chunk lexes this token again and reports its errors there
+                    diagnostics.resize(count);
+                    reported = false;
+                    break;
+                }
+                index = std::lower_bound(offsets.begin() + index, offsets.end(), next) - offsets.begin();
+                aligned = meets(index);
+                if (!aligned)
+                {
+                    stream.Push(token);
+                    if (token.type == Token::EndOfFile)
+                    {
+                        return stream;
+                    }
                 }
             }
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
+        }
+        cursor = end;
+        current = EOF;
+        return stream;
+    }
+
+    // appends chunk tokens from index on, moving identifiers over to this symbol table,
+    // line_start replaces the flag of the first one which the chunk may have lexed out of context
+    void Adopt(TokenStream &stream, Chunk &chunk, size_t index, bool line_start)
+    {
+        const auto &tokens = chunk.tokens;
+        const size_t npos = static_cast<size_t>(-1);
+        size_t numbers_from = npos;
+        size_t texts_from = npos;
+        chunk.symbols.resize(tokens.symbols->size(), SymbolTable::npos);
+        for (size_t i = index; i < tokens.size(); ++i)
+        {
+            uint32_t payload = tokens.payloads[i];
+            switch (tokens.types[i])
+            {
+            case Token::Number:
+                numbers_from = std::min<size_t>(numbers_from, payload);
+                payload = static_cast<uint32_t>(payload - numbers_from + stream.numbers.size());
+                break;
+            case Token::String:
+            case Token::Comment:
+                texts_from = std::min<size_t>(texts_from, payload);
+                payload = static_cast<uint32_t>(payload - texts_from + stream.texts.size());
+                break;
+            case Token::Identifier:
             {
-                return NumberToken();
+                auto &symbol = chunk.symbols[payload];
+                if (symbol == SymbolTable::npos)
+                {
+                    symbol = symbols->Intern(tokens.symbols->Name(payload));
+                }
+                payload = symbol;
+                break;
             }
-            case '<':
-            {
-                return XOrXXOrXEqualToken('<', Token::LeftShift, Token::LessEqual);
+            default:
+                break;
             }
-            case '>':
+            stream.payloads.push_back(payload);
+        }
+        stream.types.insert(stream.types.end(), tokens.types.begin() + index, tokens.types.end());
+        stream.offsets.insert(stream.offsets.end(), tokens.offsets.begin() + index, tokens.offsets.end());
+        size_t first = stream.newlines.size();
+        stream.newlines.insert(stream.newlines.end(), tokens.newlines.begin() + index, tokens.newlines.end());
+        if (first < stream.newlines.size())
+        {
+            stream.newlines[first] = line_start;
+        }
+        if (numbers_from != npos)
+        {
+            stream.numbers.insert(stream.numbers.end(), tokens.numbers.begin() + numbers_from, tokens.numbers.end());
+        }
+        if (texts_from != npos)
+        {
+            for (size_t i = texts_from; i < tokens.texts.size(); ++i)
             {
-                return XOrXXOrXEqualToken('>', Token::RightShift, Token::GreatEqual);
+                // escaped text goes from the chunk arena to this one
+                auto text = tokens.texts[i];
+                stream.texts.push_back(InSource(text.data()) ? text : Store(text));
             }
-            case '+':
-            {
-                return XOrXXOrXEqualToken('+', Token::PlusPlus, Token::PlusEqual);
+        }
+    }
+
+    TokenStream Tokenize(const TokenStream &previous, const SourceEdit &edit) override
+    {
+        if (streaming)
+        {
+            throw Exception("streaming lexer can not re-lex an edit");
+        }
+        if (previous.symbols != symbols)
+        {
+            throw Exception("token stream was lexed with another symbol table");
+        }
+        size_t size = end - source;
+        if (size_t(edit.offset) + edit.removed > previous.source.size() || previous.source.size() - edit.removed + edit.inserted != size)
+        {
+            throw Exception("edit does not match the token stream");
+        }
+        TokenStream stream;
+        stream.source = std::string_view(source, size);
+        stream.symbols = symbols;
+        stream.arena = arena;
+
+        // a token looks at most two characters past its end, so everything before
+        // the token in front of the one touching the edit is unaffected
+        const auto &offsets = previous.offsets;
+        size_t first = std::lower_bound(offsets.begin(), offsets.end(), edit.offset) - offsets.begin();
+        first = first >= 2 ? first - 2 : 0;
+        Reuse(stream, previous, 0, first, 0);
+
+        int64_t delta = int64_t(edit.inserted) - edit.removed;
+        uint32_t edited = edit.offset + edit.inserted;
+        size_t old = first;
+        cursor = source + (first == 0 ? 0 : offsets[first]);
+        current = EOF;
+        newline = first == 0 ? false : previous.newlines[first];
+        validated = cursor;
+        invalid = nullptr;
+        while (true)
+        {
+            Token token = Scan();
+            // past the edit a token starting where an old one started continues exactly like the old stream
+            if (token.offset >= edited)
+            {
+                uint32_t offset = static_cast<uint32_t>(token.offset - delta);
+                old = std::lower_bound(offsets.begin() + old, offsets.end(), offset) - offsets.begin();
+                // tokens after a comment take their newline flag from before it, so it can not be the one to meet
+                if (old < offsets.size() && offsets[old] == offset && token.type != Token::Comment)
+                {
+                    size_t meet = stream.size();
+                    Reuse(stream, previous, old, previous.size(), delta);
+                    // the edit may have changed the gap in front of the first reused token
+                    stream.newlines[meet] = token.newline;
+                    return stream;
+                }
             }
-            case '-':
+            stream.Push(token);
+            if (token.type == Token::EndOfFile)
             {
-                return XOrXXOrXEqualToken('-', Token::MinusMinus, Token::MinusEqual);
+                return stream;
             }
-            case '*':
+        }
+    }
+
+    // appends previous tokens [from, to) moved by delta bytes, text is rebased onto this source
+    void Reuse(TokenStream &stream, const TokenStream &previous, size_t from, size_t to, int64_t delta)
+    {
+        const char *old_begin = previous.source.data();
+        const char *old_end = old_begin + previous.source.size();
+        for (size_t index = from; index < to; ++index)
+        {
+            Token token = previous[index];
+            token.offset = static_cast<uint32_t>(token.offset + delta);
+            if (token.type == Token::String || token.type == Token::Comment)
             {
-                return XOrXEqualToken('*', Token::MultiplyEqual);
+                const char *data = token.value.text.data;
+                if (std::less_equal<const char *>()(old_begin, data) && std::less_equal<const char *>()(data, old_end))
+                {
+                    token.value.text.data = source + (data - old_begin) + delta;
+                }
+                else
+                {
+                    // escaped text lives in the arena of the previous lexer
+                    token.value.text.data = Store(token.str()).data();
+                }
             }
-            case '%':
+            stream.Push(token);
+        }
+    }
+
+    // whether the current token runs over an invalid utf-8 sequence, validation
+    // never passes a bad one so up to validated one compare answers
+    inline bool OverInvalidUtf8()
+    {
+        if (Position() <= validated)
+        {
+            return false;
+        }
+        Validate(Position());
+        return invalid && Position() > invalid;
+    }
+
+    // validates at least up to stop unless a bad sequence is found first
+    void Validate(const char *stop)
+    {
+        while (!invalid && validated < stop)
+        {
+            size_t ahead = std::max<size_t>(stop - validated, ValidateBlockSize);
+            const char *limit = static_cast<size_t>(end - validated) > ahead ? validated + ahead : end;
+            const char *bad = scan::ValidateUtf8(validated, limit);
+            if (bad == limit || (limit != end && limit - bad < 4))
             {
-                return XOrXEqualToken('%', Token::ModuloEqual);
+                // a sequence cut by the block limit is validated with the next block
+                validated = bad;
             }
-            case '&':
+            else
             {
-                return XOrXXOrXEqualToken('&', Token::And, Token::AndEqual);
+                invalid = bad;
+                validated = bad;
             }
-            case '|':
+        }
+    }
+
+    // the token over an invalid sequence becomes an Error token, validation goes on after it
+    Token InvalidUtf8()
+    {
+        const char *where = invalid;
+        invalid = nullptr;
+        validated = Position();
+        ReportAt(where, "invalid utf-8 sequence at ", Here(where));
+        return ErrorToken();
+    }
+
+    inline Token Scan()
+    {
+        if (current == EOF)
+        {
+            current = Next();
+        }
+
+        while (current != EOF)
+        {
+            token_begin = Position();
+            switch (current)
             {
-                return XOrXXOrXEqualToken('|', Token::Or, Token::OrEqual);
-            }
-            case '^':
+            case ' ':
+            case '\f':
+            case '\t':
+            case '\v':
+            case '\0':
             {
-                return XOrXEqualToken('^', Token::ExclusiveOrEqual);
+                SkipBlank();
+                break;
             }
-            case '!':
+            case '\r':
+            case '\n':
             {
-                return XOrXEqualToken('!', Token::NotEqual);
+                newline = true;
+                current = Next();
+                break;
             }
-            case '=':
+            case '\'':
+            case '"':
             {
-                return XOrXEqualToken('=', Token::Equal);
+                return SingleLineStringToken();
             }
-            case '?':
-            case ':':
-            case ';':
-            case ',':
-            case '@':
-            case '#':
-            case '(':
-            case ')':
-            case '[':
-            case ']':
-            case '{':
-            case '}':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
             {
-                auto token = current;
-                current = Next();
-                return NormalToken(token);
+                return NumberToken();
             }
-            case '.':
+            default:
             {
-                auto next = Next();
-                if (next == '.')
+                if (!op::Starts(current))
                 {
-                    next = Next();
-                    if (next == '.')
+                    return IdentifierToken();
+                }
+                auto type = OperatorType();
+                if (type == op::LineComment)
+                {
+                    auto text = SingleLineComment();
+                    if (OverInvalidUtf8())
                     {
-                        current = Next();
-                        return NormalToken(Token::VarArg);
+                        return InvalidUtf8();
                     }
-                    else
+                    if (comments == CommentMode::Keep)
                     {
-                        current = next;
-                        return NormalToken(Token::Concat);
+                        return TextToken(Token::Comment, text.data(), text.data() + text.size());
                     }
+                    break;
                 }
-                else
+                else if (type == op::BlockComment)
                 {
-                    current = next;
-                    return NormalToken('.');
+                    auto text = MultiLineComment();
+                    if (reported)
+                    {
+                        return ErrorToken();
+                    }
+                    if (OverInvalidUtf8())
+                    {
+                        return InvalidUtf8();
+                    }
+                    // a comment over several lines separates the tokens around it like a line break
+                    bool spans = scan::FindFirstOf(text.data(), text.data() + text.size(), '\r', '\n') != text.data() + text.size();
+                    if (comments == CommentMode::Keep)
+                    {
+                        Token token = TextToken(Token::Comment, text.data(), text.data() + text.size());
+                        newline = newline || spans;
+                        return token;
+                    }
+                    newline = newline || spans;
+                    break;
                 }
+                return NormalToken(type);
             }
-            default:
-                return IdentifierToken();
             }
         }
 
+        token_begin = end;
         return EndOfFileToken();
     }
 
-    char Next()
+    inline char Next()
     {
-        char next;
-        code.read(&next, sizeof(next));
-        if (code.eof())
+        if (cursor == end)
         {
+            Underflow();
             return EOF;
         }
-        column++;
-        return next;
+        // 0xFF is the EOF sentinel, the byte itself is invalid utf-8 like 0xFE
+        char ch = *cursor++;
+        return ch == EOF ? '\xFE' : ch;
     }
 
-    enum class ShouldPush
-    {
-        ForCRLF,
-        Nothing,
-    };
-    void NewLine(ShouldPush type = ShouldPush::Nothing)
+    // character after current without consuming it
+    inline char Peek()
     {
-        ++line;
-        auto next = Next();
-        if (((next == '\r' || next == '\n') && next != current) || (next == EOF))
-        {
-            if (type == ShouldPush::ForCRLF && next != EOF)
-            {
-                buffer.push_back(next);
-            }
-            column = 0;
-            current = Next();
-        }
-        else
+        if (cursor == end)
         {
-            column = 1;
-            current = next;
+            Underflow();
+            return EOF;
         }
+        return *cursor == EOF ? '\xFE' : *cursor;
+    }
+
+    // address of current, or end once the input is exhausted
+    inline const char *Position() const
+    {
+        return current == EOF ? cursor : cursor - 1;
+    }
+
+    // moves the cursor to stop and reads the character there
+    inline void SkipTo(const char *stop)
+    {
+        cursor = stop;
+        current = Next();
+    }
+
+    void SkipBlank()
+    {
+        SkipTo(scan::SkipBlank(cursor, end));
     }
 
-    inline Token StringToken(const std::string &str)
+    inline Token TextToken(token_t type, const char *begin, const char *stop)
     {
-        auto token = NormalToken(Token::String);
-        token.value = str;
+        Token token = NormalToken(type);
+        token.value.text = {begin, static_cast<uint32_t>(stop - begin), 0};
         return token;
     }
 
+    std::string_view Store(std::string_view text)
+    {
+        auto data = static_cast<char *>(arena->allocate(text.size(), 1));
+        std::memcpy(data, text.data(), text.size());
+        return std::string_view(data, text.size());
+    }
+
+    inline bool InSource(const char *data) const
+    {
+        return std::less_equal<const char *>()(source, data) && std::less_equal<const char *>()(data, end);
+    }
+
+    // keeps text that does not exist verbatim in the source, a streaming lexer views the
+    // escape buffer here and stores every text once the token is complete
+    inline Token StoredTextToken(token_t type, const std::string &text)
+    {
+        auto stored = streaming ? std::string_view(text) : Store(text);
+        return TextToken(type, stored.data(), stored.data() + stored.size());
+    }
+
     Token SingleLineStringToken()
     {
         auto quote = current;
         current = Next();
-        buffer.clear();
+        const char *begin = Position();
+        bool escaped = false;
 
         while (current != quote)
         {
             if (current == EOF)
             {
-                throw Exception("incomplete string at <eof>");
+                Report("incomplete string at <eof>");
+                return ErrorToken();
             }
 
             if (current == '\r' || current == '\n')
             {
-                throw Exception("incomplete string at line:", line, " column:", column);
+                Report("incomplete string at ", Here());
+                return ErrorToken();
             }
 
-            ConvertEscapeCharacter();
+            if (current == '\\')
+            {
+                if (!escaped)
+                {
+                    buffer.assign(begin, Position());
+                    escaped = true;
+                }
+                ConvertEscapeCharacter();
+                if (reported)
+                {
+                    return MalformedString(quote);
+                }
+            }
+            else
+            {
+                auto stop = scan::FindFirstOf(cursor, end, quote, '\\', '\r', '\n');
+                if (escaped)
+                {
+                    buffer.append(cursor - 1, stop);
+                }
+                SkipTo(stop);
+            }
         }
 
+        const char *stop = Position();
         current = Next();
-        return StringToken(buffer);
+        if (OverInvalidUtf8())
+        {
+            return InvalidUtf8();
+        }
+        return escaped ? StoredTextToken(Token::String, buffer) : TextToken(Token::String, begin, stop);
     }
 
     void ConvertEscapeCharacter()
@@ -385,11 +1060,36 @@ class LexerImpl : public Lexer
                 }
                 if (i == 0)
                 {
-                    throw Exception("unexpected character after '\\x' line:", line, " column:", column);
+                    Report("unexpected character after '\\x' ", Here());
+                    return;
                 }
                 buffer.push_back(static_cast<char>(std::strtoul(hex, 0, 16)));
                 return;
             }
+            else if (current == 'u' || current == 'U')
+            {
+                // universal character names are stored as utf-8
+                const char *name = Position() - 1;
+                char escape = current;
+                uint32_t point = 0;
+                current = Next();
+                for (int32_t i = escape == 'u' ? 4 : 8; i > 0; --i, current = Next())
+                {
+                    if (!isxdigit(current))
+                    {
+                        Report("unexpected character after '\\", escape, "' ", Here());
+                        return;
+                    }
+                    point = point << 4 | digitvalue(current);
+                }
+                if (point > 0x10FFFF || (point >= 0xD800 && point <= 0xDFFF))
+                {
+                    Report("invalid universal character name ", std::string_view(name, Position() - name), " ", Here());
+                    return;
+                }
+                AppendUtf8(buffer, point);
+                return;
+            }
             else if (isdigit(current))
             {
                 char dec[4] = {0};
@@ -400,14 +1100,16 @@ class LexerImpl : public Lexer
                 auto result = std::strtoul(dec, 0, 10);
                 if (result > 255)
                 {
-                    throw Exception("decimal escape too large near \\", result, " line:", line, " column:", column);
+                    Report("decimal escape too large near \\", result, " ", Here());
+                    return;
                 }
                 buffer.push_back(static_cast<char>(result));
                 return;
             }
             else
             {
-                throw Exception("unexpected character after '\\' line:", line, " column:", column);
+                Report("unexpected character after '\\' ", Here());
+                return;
             }
         }
         else
@@ -422,154 +1124,138 @@ class LexerImpl : public Lexer
     {
         if (!isidhead(current))
         {
-            throw Exception("unexpected character :'", current, "' line:", line, " column:", column);
+            Report("unexpected character :'", current, "' ", Here());
+            current = Next();
+            return ErrorToken();
         }
-        buffer.clear();
-        buffer.push_back(current);
+        const char *begin = Position();
         current = Next();
 
         while (isidbody(current))
         {
-            buffer.push_back(current);
             current = Next();
         }
+        if (OverInvalidUtf8())
+        {
+            return InvalidUtf8();
+        }
 
-        if (current == '"' && buffer == "R")
+        std::string_view word(begin, static_cast<size_t>(Position() - begin));
+        if (current == '"' && word == "R")
         {
             return RawStringToken();
         }
 
-        auto itrKW = KeyWords.find(buffer);
-        if (itrKW != KeyWords.end())
+        auto type = GetKeyWord(word);
+        if (type != Token::Identifier)
         {
-            return NormalToken(itrKW->second);
+            return NormalToken(type);
         }
 
-        Token token = NormalToken(Token::Identifier);
-        token.value = buffer;
+        auto symbol = symbols->Intern(word);
+        auto name = symbols->Name(symbol);
+        Token token = TextToken(Token::Identifier, name.data(), name.data() + name.size());
+        token.value.text.symbol = symbol;
         return token;
     }
 
     Token RawStringToken()
     {
-        buffer.clear();
-        const int32_t max_delimiter_length = 16;
-        std::string delimiter = "";
-        delimiter.reserve(max_delimiter_length);
+        const size_t max_delimiter_length = 16;
         current = Next();
-        while (isdelimiter(current) && (delimiter.length() < max_delimiter_length))
+        const char *tag = Position();
+        while (isdelimiter(current) && (static_cast<size_t>(Position() - tag) < max_delimiter_length))
         {
-            delimiter.push_back(current);
             current = Next();
         }
         if (isdelimiter(current))
         {
-            throw Exception("raw string delimiter longer than ", max_delimiter_length, " characters : line:", line, " column:", column);
+            Report("raw string delimiter longer than ", max_delimiter_length, " characters : ", Here());
+            return MalformedString('"');
         }
         if (current != '(')
         {
-            throw Exception("invalid character in raw string delimiter :", current, " line:", line, " column:", column);
+            Report("invalid character in raw string delimiter :", current, " ", Here());
+            return MalformedString('"');
         }
-        delimiter.push_back('"');
+        std::string_view delimiter(tag, static_cast<size_t>(Position() - tag));
         current = Next();
-        bool finished = false;
-        while (!finished)
+        const char *begin = Position();
+        while (true)
         {
             if (current == EOF)
             {
-                throw Exception("incomplete raw string at <eof>");
+                Report("incomplete raw string at <eof>");
+                return ErrorToken();
             }
-            while (current != ')' && current != EOF)
+            if (current != ')')
             {
-                buffer.push_back(current);
-                current = Next();
+                SkipTo(scan::FindFirstOf(cursor, end, ')', ')'));
+                continue;
             }
+            const char *close = Position();
             current = Next();
-            std::string matchdelimiter = "";
-            for (const char dchar : delimiter)
+            size_t matched = 0;
+            while (matched < delimiter.length() && current == delimiter[matched])
             {
-                if (current != dchar)
-                {
-                    break;
-                }
-                matchdelimiter.push_back(dchar);
+                ++matched;
                 current = Next();
             }
-            if (matchdelimiter.length() == delimiter.length())
-            {
-                finished = true;
-            }
-            else
+            if (matched == delimiter.length() && current == '"')
             {
-                buffer.push_back(')');
-                buffer.append(matchdelimiter);
+                current = Next();
+                if (OverInvalidUtf8())
+                {
+                    return InvalidUtf8();
+                }
+                return TextToken(Token::String, begin, close);
             }
         }
-
-        return StringToken(buffer);
-    }
-
-    inline Token CommentToken(const std::string &str)
-    {
-        Token token = NormalToken(Token::Comment);
-        token.value = str;
-        return token;
     }
 
-    Token SingleLineCommentToken()
+    // comment bodies are returned as spans of the source and never copied
+    std::string_view SingleLineComment()
     {
-        buffer.clear();
-        while (current != '\r' && current != '\n' && current != EOF)
+        const char *begin = Position();
+        if (current != '\r' && current != '\n' && current != EOF)
         {
-            buffer.push_back(current);
-            current = Next();
+            SkipTo(scan::FindFirstOf(cursor, end, '\r', '\n'));
         }
-        return CommentToken(buffer);
+        return std::string_view(begin, Position() - begin);
     }
 
-    Token MultiLineCommentToken()
+    std::string_view MultiLineComment()
     {
-        buffer.clear();
-        bool finished = false;
+        const char *begin = Position();
         while (current != EOF)
         {
-            if (current == '\r' || current == '\n')
-            {
-                buffer.push_back(current);
-                NewLine(ShouldPush::ForCRLF);
-            }
-            else if (current == '*')
+            if (current == '*')
             {
+                const char *star = Position();
                 auto next = Next();
                 if (next == '/')
                 {
-                    finished = true;
                     current = Next();
-                    break;
+                    return std::string_view(begin, star - begin);
                 }
                 else
                 {
-                    buffer.push_back(current);
                     current = next;
                 }
             }
             else
             {
-                buffer.push_back(current);
-                current = Next();
+                SkipTo(scan::FindFirstOf(cursor, end, '*', '*'));
             }
         }
 
-        if (!finished)
-        {
-            throw Exception("comment unclosed at <eof>");
-        }
-        return CommentToken(buffer);
+        Report("comment unclosed at <eof>");
+        return std::string_view(begin, Position() - begin);
     }
 
     Token NumberToken()
     {
-        buffer.clear();
+        const char *begin = Position();
         if (current == '0')
         {
             auto next = Next();
@@ -580,57 +1266,77 @@ class LexerImpl : public Lexer
             }
             else if (next == 'x' || next == 'X')
             {
-                buffer.push_back(current);
-                buffer.push_back(next);
                 current = Next();
-                return DecHexNumberToken(ERadix::Hex);
+                return DecHexNumberToken(ERadix::Hex, Position());
             }
             else if (isdigit(next))
             {
-                buffer.push_back(current);
                 current = next;
                 return OctNumberToken();
             }
             else
             {
-                buffer.push_back(current);
                 current = next;
             }
         }
-        return DecHexNumberToken(ERadix::Dec);
+        return DecHexNumberToken(ERadix::Dec, begin);
+    }
+
+    // a ' between two digits of the literal is a digit separator
+    inline bool IsDigitSeparator(bool after_digit, uint32_t radix)
+    {
+        return current == '\'' && after_digit && digitvalue(Peek()) < radix;
+    }
+
+    // number = number * radix + digit, returns false on overflow
+    static inline bool Accumulate(uint64_t &number, uint32_t radix, uint32_t digit)
+    {
+        if (number > (std::numeric_limits<uint64_t>::max() - digit) / radix)
+        {
+            return false;
+        }
+        number = number * radix + digit;
+        return true;
     }
 
     Token BinNumberToken()
     {
-        bool should_push = false;
         bool is_signed = true;
         bool has_digit = false;
         size_t bit = 32;
-        while (isxdigit(current))
+        size_t length = 0;
+        uint64_t number = 0;
+        while (true)
         {
             if (isbdigit(current))
             {
                 has_digit = true;
-                should_push = (should_push || current == '1');  // trim 0
-                if (should_push)
+                if (length > 0 || current == '1')  // trim 0
                 {
-                    buffer.push_back(current);
+                    ++length;
+                    number = (number << 1) | static_cast<uint64_t>(current - '0');
                 }
                 current = Next();
             }
+            else if (isxdigit(current))
+            {
+                Report("unexpected digit '", current, "' in binary number literal at ", Here());
+                return MalformedNumber();
+            }
+            else if (IsDigitSeparator(has_digit, 2))
+            {
+                current = Next();
+            }
             else
             {
-                throw Exception("unexpected digit '", current, "' in binary number literal at line:", line, " column:", column);
+                break;
             }
         }
 
         if (!has_digit)
         {
-            throw Exception("expect digit after binary number literal prefix at line:", line, " column:", column);
-        }
-        else if (buffer.empty())
-        {
-            buffer.push_back('0');
+            Report("expect digit after binary number literal prefix at ", Here());
+            return MalformedNumber();
         }
 
         bool should_match_bit = false;
@@ -645,24 +1351,30 @@ class LexerImpl : public Lexer
         }
         else if (isidhead(current))
         {
-            throw Exception("unexpected character '", current, "' after binary number literal at line:", line, " column:", column);
+            Report("unexpected character '", current, "' after binary number literal at ", Here());
+            return MalformedNumber();
         }
         else if (current == '.')
         {
-            throw Exception("unexpected '.' in binary number literal at line:", line, " column:", column);
+            Report("unexpected '.' in binary number literal at ", Here());
+            return MalformedNumber();
         }
-        current = Next();
         if (should_match_bit)
         {
+            current = Next();
             bit = ParseBit();
-            if (buffer.length() > bit)
+            if (reported)
             {
-                throw Exception("binary number literal is out of range at line:", line, " column:", column);
+                return MalformedNumber();
+            }
+            if (length > bit)
+            {
+                Report("binary number literal is out of range at ", Here());
+                return MalformedNumber();
             }
         }
         else
         {
-            auto length = buffer.length();
             if (length <= 32)
             {
                 bit = 32;
@@ -673,18 +1385,19 @@ class LexerImpl : public Lexer
             }
             else
             {
-                throw Exception("binary number literal is out of range at line:", line, " column:", column);
+                Report("binary number literal is out of range at ", Here());
+                return MalformedNumber();
             }
         }
 
         if (is_signed)
         {
-            int64_t number = std::strtoll(buffer.c_str(), nullptr, 2);
-            return NumberTokenByBit<true>(number, bit);
+            // all 64 bits set saturates like strtoll
+            auto max = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+            return NumberTokenByBit<true>(static_cast<int64_t>(number > max ? max : number), bit);
         }
         else
         {
-            uint64_t number = std::strtoull(buffer.c_str(), nullptr, 2);
             return NumberTokenByBit<false>(number, bit);
         }
     }
@@ -726,16 +1439,27 @@ class LexerImpl : public Lexer
     {
         bool is_signed = true;
         size_t bit = 32;
-        while (isxdigit(current))
+        uint64_t number = 0;
+        bool in_range = true;
+        while (true)
         {
             if (isodigit(current))
             {
-                buffer.push_back(current);
+                in_range = Accumulate(number, 8, static_cast<uint32_t>(current - '0')) && in_range;
+                current = Next();
+            }
+            else if (isxdigit(current))
+            {
+                Report("unexpected digit '", current, "' in octal number literal at ", Here());
+                return MalformedNumber();
+            }
+            else if (IsDigitSeparator(true, 8))
+            {
                 current = Next();
             }
             else
             {
-                throw Exception("unexpected digit '", current, "' in octal number literal at line:", line, " column:", column);
+                break;
             }
         }
         bool should_match_bit = false;
@@ -750,118 +1474,152 @@ class LexerImpl : public Lexer
         }
         else if (isidhead(current))
         {
-            throw Exception("unexpected character '", current, "' after octal number literal at line:", line, " column:", column);
+            Report("unexpected character '", current, "' after octal number literal at ", Here());
+            return MalformedNumber();
         }
         else if (current == '.')
         {
-            throw Exception("unexpected '.' in octal number literal at line:", line, " column:", column);
+            Report("unexpected '.' in octal number literal at ", Here());
+            return MalformedNumber();
         }
-        current = Next();
         if (should_match_bit)
         {
+            current = Next();
             bit = ParseBit();
-        }
-        bool RangeError = false;
-        errno = 0;
-
-        if (!should_match_bit)
-        {
-            uint64_t number = std::strtoull(buffer.c_str(), nullptr, 8);
-            if (errno == ERANGE)
-            {
-                RangeError = true;
-            }
-            else
+            if (reported)
             {
-                return AutoIntTypeNumber(number);
+                return MalformedNumber();
             }
         }
-        else if (is_signed)
+
+        if (in_range)
         {
-            int64_t number = std::strtoll(buffer.c_str(), nullptr, 8);
-            if (errno == ERANGE)
+            if (!should_match_bit)
             {
-                RangeError = true;
+                return AutoIntTypeNumber(number);
             }
-            else
+            else if (is_signed)
             {
-                RangeError = (GetDataBit<int8_t, int16_t, int32_t, int64_t>(number) > bit);
+                if (number <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) &&
+                    GetDataBit<int8_t, int16_t, int32_t, int64_t>(static_cast<int64_t>(number)) <= bit)
+                {
+                    return NumberTokenByBit<true>(static_cast<int64_t>(number), bit);
+                }
             }
-            if (!RangeError)
+            else if (GetDataBit<uint8_t, uint16_t, uint32_t, uint64_t>(number) <= bit)
             {
-                return NumberTokenByBit<true>(number, bit);
+                return NumberTokenByBit<false>(number, bit);
             }
         }
+        Report("octal number literal is out of range at ", Here());
+        return MalformedNumber();
+    }
+
+    // parses [first, last) which holds no prefix, suffix or digit separator
+    template <typename T>
+    static bool ParseFloat(const char *first, const char *last, ERadix radix, T &number)
+    {
+#if defined(__cpp_lib_to_chars)
+        auto format = radix == ERadix::Hex ? std::chars_format::hex : std::chars_format::general;
+        auto result = std::from_chars(first, last, number, format);
+        if (result.ec == std::errc::invalid_argument)
+        {
+            // "0x." has no digit, strtod reads it as 0
+            number = 0;
+            return true;
+        }
+        return result.ec == std::errc();
+#else
+        std::string text(radix == ERadix::Hex ? "0x" : "");
+        text.append(first, last);
+        errno = 0;
+        if constexpr (std::is_same_v<T, float>)
+        {
+            number = std::strtof(text.c_str(), nullptr);
+        }
         else
         {
-            uint64_t number = std::strtoull(buffer.c_str(), nullptr, 8);
-            if (errno == ERANGE)
-            {
-                RangeError = true;
-            }
-            else
-            {
-                RangeError = (GetDataBit<uint8_t, uint16_t, uint32_t, uint64_t>(number) > bit);
-            }
-            if (!RangeError)
-            {
-                return NumberTokenByBit<false>(number, bit);
-            }
+            number = std::strtod(text.c_str(), nullptr);
         }
+        bool in_range = (errno != ERANGE);
         errno = 0;
-        throw Exception("octal number literal is out of range at line:", line, " column:", column);
+        return in_range;
+#endif
+    }
+
+    template <typename T>
+    bool ParseFloat(const char *first, const char *last, bool separated, ERadix radix, T &number)
+    {
+        if (separated)
+        {
+            buffer.clear();
+            std::copy_if(first, last, std::back_inserter(buffer), [](char ch) { return ch != '\''; });
+            return ParseFloat(buffer.data(), buffer.data() + buffer.size(), radix, number);
+        }
+        return ParseFloat(first, last, radix, number);
     }
 
-    Token DecHexNumberToken(ERadix radix)
+    Token DecHexNumberToken(ERadix radix, const char *begin)
     {
         bool has_point = false;
         bool has_exponent = false;
         bool is_float = false;
         bool is_signed = true;
         bool should_match_bit = false;
+        bool separated = false;
+        bool in_range = true;
+        bool after_digit = (begin != Position());
+        uint64_t number = 0;
         size_t bit = 32;
-        while (isdigit(current, radix) || current == '.')
+        while (true)
         {
-            if (current == '.')
+            if (isdigit(current, radix))
+            {
+                in_range = Accumulate(number, static_cast<uint32_t>(radix), digitvalue(current)) && in_range;
+                after_digit = true;
+                current = Next();
+            }
+            else if (current == '.')
             {
                 if (has_point)
                 {
-                    throw Exception("multiple '.' in number literal at line:", line, " column:", column);
-                }
-                else
-                {
-                    has_point = true;
-                    buffer.push_back(current);
-                    current = Next();
+                    Report("multiple '.' in number literal at ", Here());
+                    return MalformedNumber();
                 }
+                has_point = true;
+                after_digit = false;
+                current = Next();
             }
-            else
+            else if (IsDigitSeparator(after_digit, static_cast<uint32_t>(radix)))
             {
-                buffer.push_back(current);
+                separated = true;
                 current = Next();
             }
+            else
+            {
+                break;
+            }
         }
 
         if (isexponent(current, radix))
         {
-            buffer.push_back(current);
             current = Next();
             if (current == '-' || current == '+')
             {
-                buffer.push_back(current);
                 current = Next();
             }
             while (isdigit(current, radix))
             {
-                buffer.push_back(current);
                 current = Next();
                 has_exponent = true;
             }
             if (!has_exponent)
             {
-                throw Exception("expect exponent digit at line:", line, " column:", column);
+                Report("expect exponent digit at ", Here());
+                return MalformedNumber();
             }
         }
+        const char *stop = Position();
         if (isfloat(current))
         {
             if (has_point || has_exponent)
@@ -871,14 +1629,16 @@ class LexerImpl : public Lexer
             }
             else
             {
-                throw Exception("unexpected '", current, "' after integer literal at line:", line, " column:", column);
+                Report("unexpected '", current, "' after integer literal at ", Here());
+                return MalformedNumber();
             }
         }
         else if (isunsigned(current))
         {
             if (has_point || has_exponent)
             {
-                throw Exception("unexpected '", current, "' after float literal at line:", line, " column:", column);
+                Report("unexpected '", current, "' after float literal at ", Here());
+                return MalformedNumber();
             }
             is_signed = false;
             should_match_bit = true;
@@ -887,91 +1647,63 @@ class LexerImpl : public Lexer
         {
             if (has_point || has_exponent)
             {
-                throw Exception("unexpected '", current, "' after float literal at line:", line, " column:", column);
+                Report("unexpected '", current, "' after float literal at ", Here());
+                return MalformedNumber();
             }
             should_match_bit = true;
         }
         else if (isidhead(current))
         {
-            throw Exception("unexpected '", current, "' after number literal at line:", line, " column:", column);
+            Report("unexpected '", current, "' after number literal at ", Here());
+            return MalformedNumber();
         }
         if (should_match_bit)
         {
             current = Next();
             bit = ParseBit();
+            if (reported)
+            {
+                return MalformedNumber();
+            }
         }
-        bool RangeError = false;
-        errno = 0;
+
         if (is_float)
         {
-            float number = std::strtof(buffer.c_str(), nullptr);
-            if (errno == ERANGE)
-            {
-                RangeError = true;
-            }
-            else
+            float value = 0;
+            if (ParseFloat(begin, stop, separated, radix, value))
             {
-                return NumberToken<float>(number);
+                return NumberToken<float>(value);
             }
         }
         else if (has_point || has_exponent)
         {
-            double number = std::strtod(buffer.c_str(), nullptr);
-            if (errno == ERANGE)
-            {
-                RangeError = true;
-            }
-            else
+            double value = 0;
+            if (ParseFloat(begin, stop, separated, radix, value))
             {
-                return NumberToken<double>(number);
+                return NumberToken<double>(value);
             }
         }
-        else if (!should_match_bit)
+        else if (in_range)
         {
-            uint64_t number = std::strtoull(buffer.c_str(), nullptr, static_cast<int>(radix));
-            if (errno == ERANGE)
-            {
-                RangeError = true;
-            }
-            else
+            if (!should_match_bit)
             {
                 return AutoIntTypeNumber(number);
             }
-        }
-        else if (is_signed)
-        {
-            int64_t number = std::strtoll(buffer.c_str(), nullptr, static_cast<int>(radix));
-            if (errno == ERANGE)
-            {
-                RangeError = true;
-            }
-            else
-            {
-                RangeError = (GetDataBit<int8_t, int16_t, int32_t, int64_t>(number) > bit);
-            }
-            if (!RangeError)
-            {
-                return NumberTokenByBit<true>(number, bit);
-            }
-        }
-        else
-        {
-            uint64_t number = std::strtoull(buffer.c_str(), nullptr, static_cast<int>(radix));
-            if (errno == ERANGE)
+            else if (is_signed)
             {
-                RangeError = true;
-            }
-            else
-            {
-                RangeError = (GetDataBit<uint8_t, uint16_t, uint32_t, uint64_t>(number) > bit);
+                if (number <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) &&
+                    GetDataBit<int8_t, int16_t, int32_t, int64_t>(static_cast<int64_t>(number)) <= bit)
+                {
+                    return NumberTokenByBit<true>(static_cast<int64_t>(number), bit);
+                }
             }
-            if (!RangeError)
+            else if (GetDataBit<uint8_t, uint16_t, uint32_t, uint64_t>(number) <= bit)
             {
                 return NumberTokenByBit<false>(number, bit);
             }
         }
-        errno = 0;
-        throw Exception("number literal is out of range at line:", line, " column:", column);
+        Report("number literal is out of range at ", Here());
+        return MalformedNumber();
     }
 
     template <typename Number8T, typename Number16T, typename Number32T, typename Number64T>
@@ -1036,7 +1768,9 @@ class LexerImpl : public Lexer
         }
         else
         {
-            throw Exception("unexpected postfix bit after number literal at line:", line, " column:", column);
+            Report("unexpected postfix bit after number literal at ", Here());
+            current = next;
+            return bit;
         }
         if (nextnext)
         {
@@ -1044,7 +1778,7 @@ class LexerImpl : public Lexer
         }
         if (isidbody(next))
         {
-            throw Exception("unexpected postfix character '", next, "' after number literal at line:", line, " column:", column);
+            Report("unexpected postfix character '", next, "' after number literal at ", Here());
         }
         else
         {
@@ -1057,50 +1791,54 @@ class LexerImpl : public Lexer
     Token NumberToken(T t)
     {
         Token token = NormalToken(Token::Number);
-        NumberValue value;
-        value.set(t);
-        token.value = value;
+        token.value.number.set(t);
         return token;
     }
 
-    Token XOrXXOrXEqualToken(token_t XType, token_t XXType, token_t XEqualType)
+    // longest operator at the cursor, one table step per byte
+    token_t OperatorType()
     {
-        auto next = Next();
-        if (next == current)
+        uint8_t state = 0;
+        while (uint8_t next = op::Table.next[state][op::Table.column[static_cast<uint8_t>(current)]])
         {
+            state = next;
             current = Next();
-            return NormalToken(XXType);
-        }
-        else if (next == '=')
-        {
-            current = Next();
-            return NormalToken(XEqualType);
-        }
-        else
-        {
-            current = next;
-            return NormalToken(XType);
         }
+        return op::Table.accept[state];
     }
+};
 
-    Token XOrXEqualToken(token_t XType, token_t XEqualType)
+std::unique_ptr<Lexer> Lexer::GetLexer(std::istream &code, const LexerOptions &options)
+{
+    std::string content;
+    char chunk[4096];
+    while (code.read(chunk, sizeof(chunk)) || code.gcount() > 0)
     {
-        auto next = Next();
-        if (next == '=')
-        {
-            current = Next();
-            return NormalToken(XEqualType);
-        }
-        else
-        {
-            current = next;
-            return NormalToken(XType);
-        }
+        CheckSourceSize(content.size() + static_cast<size_t>(code.gcount()));
+        content.append(chunk, static_cast<size_t>(code.gcount()));
     }
-};
+    return std::make_unique<LexerImpl>(std::move(content), options);
+}
+
+std::unique_ptr<Lexer> Lexer::GetOwningLexer(std::string &&code, const LexerOptions &options)
+{
+    CheckSourceSize(code.size());
+    return std::make_unique<LexerImpl>(std::move(code), options);
+}
+
+std::unique_ptr<Lexer> Lexer::GetStreamingLexer(std::istream &code, size_t chunk_size, const LexerOptions &options)
+{
+    return std::make_unique<LexerImpl>(code, chunk_size, options);
+}
+
+std::unique_ptr<Lexer> Lexer::GetLexer(std::string_view code, const LexerOptions &options)
+{
+    CheckSourceSize(code.size());
+    return std::make_unique<LexerImpl>(code, options);
+}
 
-std::unique_ptr<Lexer> Lexer::GetLexer(std::istream &code)
+std::unique_ptr<Lexer> Lexer::GetLexerFromFile(const std::string &path, const LexerOptions &options)
 {
-    return std::make_unique<LexerImpl>(code);
+    return std::make_unique<LexerImpl>(MappedFile(path), options);
 }
 }  // namespace cd::script
@@ -5,11 +5,65 @@
 
 #pragma once
 #include <memory>
+#include <memory_resource>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "line_index.hpp"
+#include "symbol.hpp"
 #include "token.hpp"
+#include "token_stream.hpp"
 
 namespace cd::script
 {
+enum class CommentMode
+{
+    // Comment tokens view the comment body in the source
+    Keep,
+    // comments are skipped like blanks and never reach the caller
+    Skip,
+};
+
+enum class ErrorMode
+{
+    // the first malformed token throws cd::Exception
+    Throw,
+    // malformed tokens become Error tokens and lexing goes on after them
+    Collect,
+};
+
+// an error found at byte offset, which lies within or just past its Error token
+struct Diagnostic
+{
+    uint32_t offset = 0;
+    std::string message;
+};
+
+struct LexerOptions
+{
+    // identifiers are interned here, lexers sharing a table share symbol ids,
+    // a lexer without one creates its own
+    std::shared_ptr<SymbolTable> symbols;
+    // text not found verbatim in the source, such as escaped strings, and the names of a table the
+    // lexer creates are allocated here and freed together with the arena. lexers of one compilation
+    // can share one, it is not thread safe. a lexer without one creates a monotonic arena
+    std::shared_ptr<std::pmr::memory_resource> arena = nullptr;
+    // Tokenize splits large sources into chunks lexed on up to this many threads
+    unsigned threads = 1;
+    CommentMode comments = CommentMode::Keep;
+    ErrorMode errors = ErrorMode::Throw;
+};
+
+// bytes [offset, offset + removed) of the previous source were replaced by inserted bytes
+struct SourceEdit
+{
+    uint32_t offset = 0;
+    uint32_t removed = 0;
+    uint32_t inserted = 0;
+};
+
 class Lexer
 {
   public:
@@ -37,8 +91,41 @@ class Lexer
         std::string ss;
     };
     virtual ~Lexer(){};
+    // sources are utf-8, a token holding an invalid sequence is an error.
+    // text of a token views the source or the arena, it lives as long as both do
     [[nodiscard]] virtual Token GetToken() = 0;
-    [[nodiscard]] static std::unique_ptr<Lexer> GetLexer(std::istream &code);
+    // lexes everything left in one pass, offsets are relative to the start of the source
+    [[nodiscard]] virtual TokenStream Tokenize() = 0;
+    // tokenizes the edited source of this lexer by re-lexing only around the edit and reusing
+    // the rest of previous, which must share the symbol table and comment mode of this lexer.
+    // the result does not depend on previous or its source once this returns
+    [[nodiscard]] virtual TokenStream Tokenize(const TokenStream &previous, const SourceEdit &edit) = 0;
+    [[nodiscard]] virtual SymbolTable &GetSymbolTable() = 0;
+    // errors collected so far in ErrorMode::Collect, in source order, with the message the
+    // lexer would have thrown. an edit re-lex only adds errors of the re-lexed part
+    [[nodiscard]] virtual const std::vector<Diagnostic> &GetDiagnostics() const = 0;
+    // line and column of a token offset, the line index is built on the first call
+    [[nodiscard]] virtual SourceLocation GetLocation(uint32_t offset) = 0;
+    // reads all of code up front. offsets are 32 bits, so a source of 4 GiB or more throws
+    [[nodiscard]] static std::unique_ptr<Lexer> GetLexer(std::istream &code, const LexerOptions &options = {});
+    // pulls chunk_size bytes at a time from code, which must outlive the lexer, and buffers only
+    // the current token and the chunk after it. token text is copied to the arena and lives with it,
+    // offsets wrap past 4 GiB and GetLocation only answers for offsets still buffered
+    [[nodiscard]] static std::unique_ptr<Lexer> GetStreamingLexer(std::istream &code, size_t chunk_size = 64 * 1024, const LexerOptions &options = {});
+    // lexes the buffer in place, code must outlive the lexer and throws from 4 GiB on
+    [[nodiscard]] static std::unique_ptr<Lexer> GetLexer(std::string_view code, const LexerOptions &options = {});
+    // a temporary string would dangle as a view, the lexer keeps it instead. lvalue strings and
+    // literals still go to the view overload
+    template <typename String, typename = std::enable_if_t<std::is_same_v<String, std::string>>>
+    [[nodiscard]] static std::unique_ptr<Lexer> GetLexer(String &&code, const LexerOptions &options = {})
+    {
+        return GetOwningLexer(std::move(code), options);
+    }
+    // maps the file read-only and lexes straight out of the mapping, throws from 4 GiB on
+    [[nodiscard]] static std::unique_ptr<Lexer> GetLexerFromFile(const std::string &path, const LexerOptions &options = {});
+
+  private:
+    static std::unique_ptr<Lexer> GetOwningLexer(std::string &&code, const LexerOptions &options);
 };
 
 }  // namespace cd::script
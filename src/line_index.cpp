@@ -0,0 +1,35 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "line_index.hpp"
+#include <algorithm>
+#include "scan.hpp"
+
+namespace cd::script
+{
+LineIndex::LineIndex(std::string_view source) : starts{0}, length(static_cast<uint32_t>(source.size()))
+{
+    const char *begin = source.data();
+    const char *end = begin + source.size();
+    const char *cursor = scan::FindFirstOf(begin, end, '\r', '\n');
+    while (cursor != end)
+    {
+        char ch = *cursor++;
+        if (cursor != end && (*cursor == '\r' || *cursor == '\n') && *cursor != ch)
+        {
+            ++cursor;
+        }
+        starts.push_back(static_cast<uint32_t>(cursor - begin));
+        cursor = scan::FindFirstOf(cursor, end, '\r', '\n');
+    }
+}
+
+SourceLocation LineIndex::Locate(uint32_t offset) const
+{
+    auto itr = std::upper_bound(starts.begin(), starts.end(), offset) - 1;
+    auto column = offset - *itr;
+    return {static_cast<uint32_t>(itr - starts.begin() + 1), offset < length ? column + 1 : column};
+}
+}  // namespace cd::script
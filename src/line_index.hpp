@@ -0,0 +1,44 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace cd::script
+{
+struct SourceLocation
+{
+    uint32_t line = 1;
+    uint32_t column = 0;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const SourceLocation &location)
+{
+    return os << "line:" << location.line << " column:" << location.column;
+}
+
+// start offset of every line in a source, "\r\n" and "\n\r" count as one line break
+class LineIndex
+{
+  public:
+    explicit LineIndex(std::string_view source);
+
+    // 1-based line and column of the character at offset,
+    // the end of the source reports the length of the last line as column
+    SourceLocation Locate(uint32_t offset) const;
+
+    size_t size() const
+    {
+        return starts.size();
+    }
+
+  private:
+    std::vector<uint32_t> starts;
+    uint32_t length;
+};
+}  // namespace cd::script
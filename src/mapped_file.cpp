@@ -0,0 +1,172 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "mapped_file.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include "utils.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cd
+{
+// token offsets are 32 bits
+static constexpr uint64_t MaxSize = std::numeric_limits<uint32_t>::max();
+
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string &path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw Exception("can not open file:", path);
+    }
+    if (GetFileType(file) != FILE_TYPE_DISK)
+    {
+        char chunk[4096];
+        DWORD count = 0;
+        while (ReadFile(file, chunk, sizeof(chunk), &count, nullptr) && count > 0)
+        {
+            if (buffer.size() + count > MaxSize)
+            {
+                CloseHandle(file);
+                throw Exception("file too large:", path);
+            }
+            buffer.append(chunk, count);
+        }
+        CloseHandle(file);
+        return;
+    }
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length))
+    {
+        CloseHandle(file);
+        throw Exception("can not get size of file:", path);
+    }
+    if (static_cast<uint64_t>(length.QuadPart) > MaxSize)
+    {
+        CloseHandle(file);
+        throw Exception("file too large:", path);
+    }
+    if (length.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr)
+        {
+            data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        if (data == nullptr)
+        {
+            CloseHandle(file);
+            throw Exception("can not map file:", path);
+        }
+        size = static_cast<size_t>(length.QuadPart);
+    }
+    CloseHandle(file);
+}
+
+void MappedFile::Unmap() noexcept
+{
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+    }
+}
+#else
+MappedFile::MappedFile(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw Exception("can not open file:", path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw Exception("can not get size of file:", path);
+    }
+    if (!S_ISREG(info.st_mode) || info.st_size == 0)
+    {
+        // pipes, devices and procfs files have no size to map, read them to the end
+        char chunk[4096];
+        ssize_t count;
+        while ((count = read(fd, chunk, sizeof(chunk))) != 0)
+        {
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count < 0 || buffer.size() + static_cast<size_t>(count) > MaxSize)
+            {
+                close(fd);
+                throw Exception(count < 0 ? "can not read file:" : "file too large:", path);
+            }
+            buffer.append(chunk, static_cast<size_t>(count));
+        }
+        close(fd);
+        return;
+    }
+    if (static_cast<uint64_t>(info.st_size) > MaxSize)
+    {
+        close(fd);
+        throw Exception("file too large:", path);
+    }
+    void *address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED)
+    {
+        close(fd);
+        throw Exception("can not map file:", path);
+    }
+    madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    data = static_cast<const char *>(address);
+    size = static_cast<size_t>(info.st_size);
+    close(fd);
+}
+
+void MappedFile::Unmap() noexcept
+{
+    if (data != nullptr)
+    {
+        munmap(const_cast<char *>(data), size);
+    }
+}
+#endif
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)), buffer(std::move(other.buffer))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        Unmap();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        buffer = std::move(other.buffer);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+}
+}  // namespace cd
@@ -0,0 +1,37 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace cd
+{
+// maps a file read-only, files that can not be mapped such as pipes, devices and the
+// size 0 files of /proc are read into a buffer instead. sources past 4 GiB are refused
+// because token offsets are 32 bits
+class MappedFile
+{
+  public:
+    MappedFile() noexcept = default;
+    explicit MappedFile(const std::string &path);
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    std::string_view view() const noexcept
+    {
+        return data ? std::string_view(data, size) : std::string_view(buffer);
+    }
+
+  private:
+    void Unmap() noexcept;
+    const char *data = nullptr;
+    size_t size = 0;
+    std::string buffer;
+};
+}  // namespace cd
@@ -0,0 +1,218 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "token.hpp"
+
+namespace cd::script
+{
+struct Operator
+{
+    std::string_view text;
+    token_t type;
+};
+
+namespace op
+{
+// openers of comments, the lexer reads the comment body itself
+inline constexpr token_t LineComment = -1;
+inline constexpr token_t BlockComment = -2;
+}  // namespace op
+
+// every prefix of an operator must be an operator too, so the longest match never backs up
+inline constexpr Operator Operators[] = {
+    {"+", '+'},
+    {"++", Token::PlusPlus},
+    {"+=", Token::PlusEqual},
+    {"-", '-'},
+    {"--", Token::MinusMinus},
+    {"-=", Token::MinusEqual},
+    {"*", '*'},
+    {"*=", Token::MultiplyEqual},
+    {"/", '/'},
+    {"/=", Token::DivideEqual},
+    {"//", op::LineComment},
+    {"/*", op::BlockComment},
+    {"%", '%'},
+    {"%=", Token::ModuloEqual},
+    {"&", '&'},
+    {"&&", Token::And},
+    {"&=", Token::AndEqual},
+    {"|", '|'},
+    {"||", Token::Or},
+    {"|=", Token::OrEqual},
+    {"^", '^'},
+    {"^=", Token::ExclusiveOrEqual},
+    {"!", '!'},
+    {"!=", Token::NotEqual},
+    {"=", '='},
+    {"==", Token::Equal},
+    {"<", '<'},
+    {"<<", Token::LeftShift},
+    {"<=", Token::LessEqual},
+    {">", '>'},
+    {">>", Token::RightShift},
+    {">=", Token::GreatEqual},
+    {".", '.'},
+    {"..", Token::Concat},
+    {"...", Token::VarArg},
+    {"?", '?'},
+    {":", ':'},
+    {";", ';'},
+    {",", ','},
+    {"@", '@'},
+    {"#", '#'},
+    {"(", '('},
+    {")", ')'},
+    {"[", '['},
+    {"]", ']'},
+    {"{", '{'},
+    {"}", '}'},
+};
+
+// dfa over Operators built at compile time, bytes are first mapped to columns so the
+// transition table only has a column per character that occurs in some operator
+namespace op
+{
+// type of states that accept nothing
+inline constexpr token_t None = 0;
+
+constexpr size_t CountColumns()
+{
+    std::array<bool, 256> seen{};
+    size_t count = 1;
+    for (const auto &o : Operators)
+    {
+        for (char ch : o.text)
+        {
+            auto index = static_cast<unsigned char>(ch);
+            count += seen[index] ? 0 : 1;
+            seen[index] = true;
+        }
+    }
+    return count;
+}
+
+// start state plus one state per distinct prefix
+constexpr size_t CountStates()
+{
+    size_t count = 1;
+    for (size_t i = 0; i < std::size(Operators); ++i)
+    {
+        for (size_t length = 1; length <= Operators[i].text.size(); ++length)
+        {
+            auto prefix = Operators[i].text.substr(0, length);
+            bool seen = false;
+            for (size_t j = 0; j < i && !seen; ++j)
+            {
+                seen = Operators[j].text.substr(0, length) == prefix;
+            }
+            count += seen ? 0 : 1;
+        }
+    }
+    return count;
+}
+
+inline constexpr size_t Columns = CountColumns();
+inline constexpr size_t States = CountStates();
+static_assert(States < 256, "operator states do not fit uint8_t");
+
+struct Dfa
+{
+    // column of every byte, 0 for bytes in no operator
+    std::array<uint8_t, 256> column{};
+    // next state, 0 where no operator continues
+    std::array<std::array<uint8_t, Columns>, States> next{};
+    std::array<token_t, States> accept{};
+};
+
+constexpr Dfa BuildDfa()
+{
+    Dfa dfa{};
+    uint8_t columns = 1;
+    uint8_t states = 1;
+    for (const auto &o : Operators)
+    {
+        uint8_t state = 0;
+        for (char ch : o.text)
+        {
+            auto &column = dfa.column[static_cast<unsigned char>(ch)];
+            if (column == 0)
+            {
+                column = columns++;
+            }
+            auto &next = dfa.next[state][column];
+            if (next == 0)
+            {
+                next = states++;
+            }
+            state = next;
+        }
+        dfa.accept[state] = o.type;
+    }
+    return dfa;
+}
+
+inline constexpr Dfa Table = BuildDfa();
+
+constexpr bool IsPrefixClosed()
+{
+    for (size_t state = 1; state < States; ++state)
+    {
+        if (Table.accept[state] == None)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool IsUnique()
+{
+    for (size_t i = 0; i < std::size(Operators); ++i)
+    {
+        for (size_t j = 0; j < i; ++j)
+        {
+            if (Operators[i].text == Operators[j].text)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(IsPrefixClosed(), "every prefix of an operator must be an operator");
+static_assert(IsUnique(), "operator listed twice");
+
+constexpr bool Starts(char ch)
+{
+    return Table.next[0][Table.column[static_cast<unsigned char>(ch)]] != 0;
+}
+
+// type of the longest operator at the start of text, None if there is none
+constexpr token_t Match(std::string_view text)
+{
+    uint8_t state = 0;
+    for (char ch : text)
+    {
+        uint8_t next = Table.next[state][Table.column[static_cast<unsigned char>(ch)]];
+        if (next == 0)
+        {
+            break;
+        }
+        state = next;
+    }
+    return Table.accept[state];
+}
+
+static_assert(Match("...") == Token::VarArg);
+static_assert(Match("<<=") == Token::LeftShift);
+static_assert(Match("a") == None);
+}  // namespace op
+}  // namespace cd::script
@@ -4,32 +4,206 @@
 // https://opensource.org/licenses/MIT
 
 #include "parser.hpp"
+#include <array>
 #include <cassert>
+#include <optional>
+#include <vector>
+#include "keyword.hpp"
 #include "lexer.hpp"
+#include "operator.hpp"
 #include "syntax.hpp"
 #include "utils.hpp"
 
 namespace cd::script
 {
-class ParserImpl : public Parser
+// pulls tokens from a lexer into a fixed ring, the current token and up to Capacity - 1
+// lookahead tokens stay in place until they are consumed
+class LexerTokenSource
 {
+  public:
+    static constexpr size_t Capacity = 4;
+
   private:
+    static_assert((Capacity & (Capacity - 1)) == 0, "ring capacity must be a power of two");
     std::unique_ptr<Lexer> &lexer;
-    Token current;
-    Token ahead1;
-    Token ahead2;
+    std::array<Token, Capacity> ring;
+    // slot of the current token and number of lookahead tokens buffered after it
+    size_t head = 0;
+    size_t buffered = 0;
     Token lastcomment;
 
+    Token &Slot(size_t distance)
+    {
+        return ring[(head + distance) & (Capacity - 1)];
+    }
+
   public:
-    ParserImpl(std::unique_ptr<Lexer> &_lexer)
+    LexerTokenSource(std::unique_ptr<Lexer> &_lexer)
         : lexer(_lexer)
     {
     }
+
+    Token GetNoCommentToken()
+    {
+        Token token = lexer->GetToken();
+        while (token.type == Token::Comment)
+        {
+            lastcomment = token;
+            token = lexer->GetToken();
+        }
+        return token;
+    }
+
+    Token &NextToken()
+    {
+        if (buffered == 0)
+        {
+            Slot(1) = GetNoCommentToken();
+        }
+        else
+        {
+            --buffered;
+        }
+        head = (head + 1) & (Capacity - 1);
+        return ring[head];
+    }
+
+    std::optional<SourceLocation> Locate(uint32_t offset)
+    {
+        return lexer->GetLocation(offset);
+    }
+
+    // k-th token after the current one
+    Token &LookAhead(size_t k = 1)
+    {
+        assert(k > 0 && k < Capacity);
+        while (buffered < k)
+        {
+            Slot(++buffered) = GetNoCommentToken();
+        }
+        return Slot(k);
+    }
+};
+
+// reads a pre-lexed TokenStream, lookahead is plain indexing
+class StreamTokenSource
+{
+  private:
+    const TokenStream &stream;
+    size_t index;
+    std::unique_ptr<LineIndex> lines;
+
+    size_t SkipComment(size_t i) const
+    {
+        while (i < stream.size() && stream.types[i] == Token::Comment)
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    size_t Last() const
+    {
+        return stream.size() - 1;
+    }
+
+  public:
+    StreamTokenSource(const TokenStream &_stream)
+        : stream(_stream), index(SkipComment(0))
+    {
+    }
+
+    // a default constructed stream has not even EndOfFile, it reads as one
+    bool Empty() const
+    {
+        return stream.size() == 0;
+    }
+
+    Token NextToken()
+    {
+        if (Empty())
+        {
+            return Token();
+        }
+        auto i = index;
+        if (i != Last())
+        {
+            index = SkipComment(i + 1);
+        }
+        return stream[i];
+    }
+
+    // a stream lexed from an istream keeps no source to count lines in
+    std::optional<SourceLocation> Locate(uint32_t offset)
+    {
+        if (offset >= stream.source.size())
+        {
+            return std::nullopt;
+        }
+        if (!lines)
+        {
+            lines = std::make_unique<LineIndex>(stream.source);
+        }
+        return lines->Locate(offset);
+    }
+
+    // k-th token after the current one, EndOfFile repeats past the end
+    Token LookAhead(size_t k = 1) const
+    {
+        if (Empty())
+        {
+            return Token();
+        }
+        auto i = index;
+        while (--k > 0 && i != Last())
+        {
+            i = SkipComment(i + 1);
+        }
+        return stream[i];
+    }
+};
+
+template <typename TokenSource>
+class ParserImpl : public Parser
+{
+  private:
+    TokenSource tokens;
+    std::unique_ptr<SyntaxArena> arena;
+    ErrorMode errors;
+    std::vector<Diagnostic> diagnostics;
+
+  public:
+    template <typename Input>
+    ParserImpl(Input &input, ErrorMode _errors)
+        : tokens(input), errors(_errors)
+    {
+    }
     ~ParserImpl() {}
 
-    std::unique_ptr<Syntax> GetAbstractSyntaxTree() override
+    SyntaxTree GetAbstractSyntaxTree() override
+    {
+        arena = std::make_unique<SyntaxArena>();
+        while (true)
+        {
+            while (LookAhead().type == ';')
+            {
+                NextToken();
+            }
+            if (LookAhead().type == Token::EndOfFile)
+            {
+                return {std::move(arena), nullptr};
+            }
+            if (auto statement = ParseStatement())
+            {
+                return {std::move(arena), std::move(statement)};
+            }
+            Synchronize();
+        }
+    }
+
+    const std::vector<Diagnostic> &GetDiagnostics() const override
     {
-        return ParseExpression();
+        return diagnostics;
     }
 
   private:
@@ -71,53 +245,75 @@ class ParserImpl : public Parser
         }
     }
 
-    bool IsPrimaryExpression(token_t type)
+    // an expression ended by ';', a line break or the end of input, nullptr after an error
+    syntax_t ParseStatement()
     {
-        switch (type)
+        auto expression = ParseExpression();
+        if (!expression)
         {
-        case Token::Null:
-        case Token::True:
-        case Token::False:
-        case Token::Number:
-        case Token::String:
-            return true;
-        default:
-            return false;
+            return nullptr;
+        }
+        const auto &next = LookAhead();
+        if (next.type == ';')
+        {
+            NextToken();
         }
+        else if (next.type != Token::EndOfFile && !next.newline)
+        {
+            Unexpected(next, "end of statement");
+            return nullptr;
+        }
+        return expression;
     }
 
-    syntax_t ParseExpression(syntax_t left = syntax_t(), precedence_t left_precedence = 0, Token op = Token())
+    // panic mode, drops tokens up to and including the next ';' or '}', or up to the first
+    // token on a new line. at least one token goes so a statement can not fail twice in place
+    void Synchronize()
     {
-        LookAhead();
-        std::unique_ptr<Syntax> expression;
-        if (IsPrimaryExpression(ahead1.type))
+        for (bool dropped = false;; dropped = true)
         {
-            expression = ParsePrimaryExpression();
-        }
-        while (true)
-        {
-            int right_precedence = GetOperatorPrecedence(LookAhead().type);
-            if (left_precedence < right_precedence)
+            const auto &token = LookAhead();
+            if (token.type == Token::EndOfFile || (dropped && token.newline))
             {
-                expression = ParseExpression(std::move(expression), right_precedence, NextToken());
+                return;
             }
-            else if (left_precedence == right_precedence)
+            auto type = NextToken().type;
+            if (type == ';' || type == '}')
             {
-                if (left_precedence == 0)
-                    return expression;
-                assert(left);
-                expression = std::make_unique<BinaryExpression>(std::move(left), std::move(expression), std::move(op));
-                return ParseExpression(std::move(expression), right_precedence, NextToken());
+                return;
             }
-            else
+        }
+    }
+
+    // shunting-yard over GetOperatorPrecedence, operators waiting for their right operand are kept
+    // on an explicit stack of strictly rising precedence instead of one call per operator
+    syntax_t ParseExpression()
+    {
+        struct Pending
+        {
+            syntax_t left;
+            Token op;
+            precedence_t precedence;
+        };
+        std::vector<Pending> pending;
+        syntax_t expression = ParsePrimaryExpression();
+        while (expression)
+        {
+            auto precedence = GetOperatorPrecedence(LookAhead().type);
+            while (!pending.empty() && pending.back().precedence >= precedence)
+            {
+                auto &top = pending.back();
+                expression = arena->Make<BinaryExpression>(std::move(top.left), std::move(expression), std::move(top.op));
+                pending.pop_back();
+            }
+            if (precedence == 0)
             {
-                if (left)
-                {
-                    expression = std::make_unique<BinaryExpression>(std::move(left), std::move(expression), std::move(op));
-                }
                 return expression;
             }
+            pending.push_back({std::move(expression), NextToken(), precedence});
+            expression = ParsePrimaryExpression();
         }
+        return nullptr;
     }
 
     syntax_t ParsePrimaryExpression()
@@ -129,63 +325,98 @@ class ParserImpl : public Parser
         case Token::False:
         case Token::Number:
         case Token::String:
-            return std::make_unique<LiteralValue>(std::move(NextToken()));
+            return arena->Make<LiteralValue>(std::move(NextToken()));
         default:
-            throw - 1;
+            Unexpected(LookAhead(), "expression");
+            return nullptr;
         }
     }
 
-    Token GetNoCommentToken()
+    void Unexpected(const Token &token, const char *expected)
     {
-        Token token = lexer->GetToken();
-        while (token.type == Token::Comment)
+        // the lexer has collected what is wrong with an Error token already
+        if (token.type == Token::Error && errors == ErrorMode::Collect)
         {
-            lastcomment = std::move(token);
-            token = lexer->GetToken();
+            return;
         }
-        return token;
-    }
-
-    Token &NextToken()
-    {
-        if (ahead1.type != Token::EndOfFile)
+        if (token.type == Token::EndOfFile)
         {
-            current = ahead1;
-            ahead1 = ahead2;
-            if (ahead2.type != Token::EndOfFile)
-            {
-                ahead2.type = Token::EndOfFile;
-            }
+            Report(token.offset, "expect ", expected, " at <eof>");
         }
         else
         {
-            current = GetNoCommentToken();
+            auto location = tokens.Locate(token.offset);
+            if (location)
+            {
+                Report(token.offset, "expect ", expected, " but got ", Describe(token), " at ", *location);
+            }
+            else
+            {
+                Report(token.offset, "expect ", expected, " but got ", Describe(token), " at <unknown location>");
+            }
         }
-        return current;
     }
 
-    Token &LookAhead()
+    template <typename... Args>
+    void Report(uint32_t offset, Args &&... args)
     {
-        if (ahead1.type == Token::EndOfFile)
+        if (errors == ErrorMode::Throw)
         {
-            ahead1 = GetNoCommentToken();
+            throw Exception(std::forward<Args>(args)...);
         }
-        return ahead1;
+        diagnostics.push_back({offset, Exception(std::forward<Args>(args)...).what()});
     }
 
-    Token &LookAhead2()
+    static std::string Describe(const Token &token)
     {
-        LookAhead();
-        if (ahead2.type == Token::EndOfFile)
+        switch (token.type)
+        {
+        case Token::Number:
+            return "number";
+        case Token::String:
+            return "string";
+        case Token::Identifier:
+            return "identifier '" + std::string(token.str()) + "'";
+        case Token::Error:
+            return "invalid token";
+        default:
+            break;
+        }
+        for (const auto &op : Operators)
+        {
+            if (op.type == token.type)
+            {
+                return "'" + std::string(op.text) + "'";
+            }
+        }
+        for (const auto &keyword : KeyWords)
         {
-            ahead2 = GetNoCommentToken();
+            if (keyword.type == token.type)
+            {
+                return "'" + std::string(keyword.word) + "'";
+            }
         }
-        return ahead2;
+        return "token " + std::to_string(token.type);
+    }
+
+    decltype(auto) NextToken()
+    {
+        return tokens.NextToken();
+    }
+
+    decltype(auto) LookAhead(size_t k = 1)
+    {
+        return tokens.LookAhead(k);
     }
 };
 
-std::unique_ptr<Parser> Parser::GetParser(std::unique_ptr<Lexer> &lexer)
+std::unique_ptr<Parser> Parser::GetParser(std::unique_ptr<Lexer> &lexer, ErrorMode errors)
+{
+    return std::make_unique<ParserImpl<LexerTokenSource>>(lexer, errors);
+}
+
+std::unique_ptr<Parser> Parser::GetParser(const TokenStream &tokens, ErrorMode errors)
 {
-    return std::make_unique<ParserImpl>(lexer);
+    return std::make_unique<ParserImpl<StreamTokenSource>>(tokens, errors);
 }
 }  // namespace cd::script
@@ -6,7 +6,9 @@
 #pragma once
 
 #include <sstream>
+#include "lexer.hpp"
 #include "syntax.hpp"
+#include "token_stream.hpp"
 
 namespace cd::script
 {
@@ -14,7 +16,15 @@ class Parser
 {
   public:
     virtual ~Parser(){};
-    [[nodiscard]] virtual std::unique_ptr<class Syntax> GetAbstractSyntaxTree() = 0;
-    [[nodiscard]] static std::unique_ptr<Parser> GetParser(std::unique_ptr<class Lexer> &lexer);
+    // parses the next statement, an expression ended by ';' or a line break, the tree is empty
+    // once the input is used up. nodes are allocated in an arena owned by the returned tree.
+    // with ErrorMode::Collect a malformed statement is reported and skipped up to the next
+    // ';', '}' or line break, and parsing goes on with the statement after it
+    [[nodiscard]] virtual SyntaxTree GetAbstractSyntaxTree() = 0;
+    // syntax errors collected so far in ErrorMode::Collect, in source order
+    [[nodiscard]] virtual const std::vector<Diagnostic> &GetDiagnostics() const = 0;
+    [[nodiscard]] static std::unique_ptr<Parser> GetParser(std::unique_ptr<class Lexer> &lexer, ErrorMode errors = ErrorMode::Throw);
+    // tokens must outlive the parser, errors are only located when tokens.source covers them
+    [[nodiscard]] static std::unique_ptr<Parser> GetParser(const TokenStream &tokens, ErrorMode errors = ErrorMode::Throw);
 };
 }  // namespace cd::script
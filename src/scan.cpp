@@ -0,0 +1,409 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "scan.hpp"
+#include <cstddef>
+#include <cstdint>
+#include "charclass.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CDSCRIPT_SCAN_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define CDSCRIPT_SCAN_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace cd::script::scan
+{
+namespace
+{
+inline bool isblank(char ch)
+{
+    return charclass::Is(ch, charclass::Blank);
+}
+
+inline uint32_t CountTrailingZero(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+const char *SkipBlankScalar(const char *begin, const char *end)
+{
+    while (begin != end && isblank(*begin))
+    {
+        ++begin;
+    }
+    return begin;
+}
+
+const char *FindFirstOfScalar(const char *begin, const char *end, char a, char b, char c, char d)
+{
+    while (begin != end && *begin != a && *begin != b && *begin != c && *begin != d)
+    {
+        ++begin;
+    }
+    return begin;
+}
+
+inline bool IsContinuation(const char *p)
+{
+    return (static_cast<uint8_t>(*p) & 0xC0) == 0x80;
+}
+
+// end of the well-formed sequence starting at begin, nullptr if there is none
+inline const char *Utf8Sequence(const char *begin, const char *end)
+{
+    auto lead = static_cast<uint8_t>(*begin);
+    if (lead < 0x80)
+    {
+        return begin + 1;
+    }
+    // second byte range of the lead byte, excluding overlong forms, surrogates and code points past U+10FFFF
+    uint8_t low = 0x80;
+    uint8_t high = 0xBF;
+    std::ptrdiff_t length;
+    if (lead < 0xC2)
+    {
+        return nullptr;
+    }
+    else if (lead < 0xE0)
+    {
+        length = 2;
+    }
+    else if (lead < 0xF0)
+    {
+        length = 3;
+        low = lead == 0xE0 ? 0xA0 : low;
+        high = lead == 0xED ? 0x9F : high;
+    }
+    else if (lead < 0xF5)
+    {
+        length = 4;
+        low = lead == 0xF0 ? 0x90 : low;
+        high = lead == 0xF4 ? 0x8F : high;
+    }
+    else
+    {
+        return nullptr;
+    }
+    if (end - begin < length)
+    {
+        return nullptr;
+    }
+    auto second = static_cast<uint8_t>(begin[1]);
+    if (second < low || second > high)
+    {
+        return nullptr;
+    }
+    for (std::ptrdiff_t i = 2; i < length; ++i)
+    {
+        if (!IsContinuation(begin + i))
+        {
+            return nullptr;
+        }
+    }
+    return begin + length;
+}
+
+const char *ValidateUtf8Scalar(const char *begin, const char *end)
+{
+    while (begin != end)
+    {
+        const char *next = Utf8Sequence(begin, end);
+        if (next == nullptr)
+        {
+            return begin;
+        }
+        begin = next;
+    }
+    return end;
+}
+
+// a sequence start at most 3 bytes before block, everything before block is known to be valid
+inline const char *Utf8Boundary(const char *begin, const char *block)
+{
+    const char *p = block - begin > 3 ? block - 3 : begin;
+    while (p != block && IsContinuation(p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef CDSCRIPT_SCAN_SSE2
+inline __m128i BlankMask16(__m128i chunk)
+{
+    __m128i mask = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\v')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\f')));
+    return _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_setzero_si128()));
+}
+
+const char *SkipBlankSSE2(const char *begin, const char *end)
+{
+    for (; end - begin >= 16; begin += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        uint32_t stop = ~static_cast<uint32_t>(_mm_movemask_epi8(BlankMask16(chunk))) & 0xFFFFu;
+        if (stop != 0)
+        {
+            return begin + CountTrailingZero(stop);
+        }
+    }
+    return SkipBlankScalar(begin, end);
+}
+
+const char *FindFirstOfSSE2(const char *begin, const char *end, char a, char b, char c, char d)
+{
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vd = _mm_set1_epi8(d);
+    for (; end - begin >= 16; begin += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i mask = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+        mask = _mm_or_si128(mask, _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd)));
+        uint32_t found = static_cast<uint32_t>(_mm_movemask_epi8(mask));
+        if (found != 0)
+        {
+            return begin + CountTrailingZero(found);
+        }
+    }
+    return FindFirstOfScalar(begin, end, a, b, c, d);
+}
+
+// skips ascii 16 bytes at a time and decodes the rest one sequence after another
+const char *ValidateUtf8SSE2(const char *begin, const char *end)
+{
+    while (end - begin >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        if (_mm_movemask_epi8(chunk) == 0)
+        {
+            begin += 16;
+            continue;
+        }
+        for (const char *stop = begin + 16; begin < stop;)
+        {
+            const char *next = Utf8Sequence(begin, end);
+            if (next == nullptr)
+            {
+                return begin;
+            }
+            begin = next;
+        }
+    }
+    return ValidateUtf8Scalar(begin, end);
+}
+#endif
+
+#ifdef CDSCRIPT_SCAN_AVX2
+__attribute__((target("avx2"))) const char *SkipBlankAVX2(const char *begin, const char *end)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i vtab = _mm256_set1_epi8('\v');
+    const __m256i feed = _mm256_set1_epi8('\f');
+    const __m256i zero = _mm256_setzero_si256();
+    for (; end - begin >= 32; begin += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i mask = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab));
+        mask = _mm256_or_si256(mask, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vtab), _mm256_cmpeq_epi8(chunk, feed)));
+        mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, zero));
+        uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(mask));
+        if (stop != 0)
+        {
+            return begin + CountTrailingZero(stop);
+        }
+    }
+    return SkipBlankSSE2(begin, end);
+}
+
+__attribute__((target("avx2"))) const char *FindFirstOfAVX2(const char *begin, const char *end, char a, char b, char c, char d)
+{
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    const __m256i vc = _mm256_set1_epi8(c);
+    const __m256i vd = _mm256_set1_epi8(d);
+    for (; end - begin >= 32; begin += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i mask = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb));
+        mask = _mm256_or_si256(mask, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vc), _mm256_cmpeq_epi8(chunk, vd)));
+        uint32_t found = static_cast<uint32_t>(_mm256_movemask_epi8(mask));
+        if (found != 0)
+        {
+            return begin + CountTrailingZero(found);
+        }
+    }
+    return FindFirstOfSSE2(begin, end, a, b, c, d);
+}
+
+// error bits of the utf-8 lookup validation, Keiser and Lemire, "Validating UTF-8 In Less Than One
+// Instruction Per Byte". three nibble lookups classify every pair of adjacent bytes, the multi-byte
+// length check catches missing or extra continuation bytes of 3 and 4 byte sequences
+namespace utf8
+{
+inline constexpr uint8_t TooShort = 1 << 0;
+inline constexpr uint8_t TooLong = 1 << 1;
+inline constexpr uint8_t Overlong3 = 1 << 2;
+inline constexpr uint8_t TooLarge = 1 << 3;
+inline constexpr uint8_t Surrogate = 1 << 4;
+inline constexpr uint8_t Overlong2 = 1 << 5;
+inline constexpr uint8_t TooLarge1000 = 1 << 6;
+inline constexpr uint8_t Overlong4 = 1 << 6;
+inline constexpr uint8_t TwoConts = 1 << 7;
+inline constexpr uint8_t Carry = TooShort | TooLong | TwoConts;
+}  // namespace utf8
+
+__attribute__((target("avx2"))) inline __m256i Lookup16(__m256i nibbles, uint8_t t0, uint8_t t1, uint8_t t2, uint8_t t3, uint8_t t4, uint8_t t5, uint8_t t6, uint8_t t7,
+                                                        uint8_t t8, uint8_t t9, uint8_t t10, uint8_t t11, uint8_t t12, uint8_t t13, uint8_t t14, uint8_t t15)
+{
+    const __m256i table = _mm256_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15,
+                                           t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15);
+    return _mm256_shuffle_epi8(table, nibbles);
+}
+
+__attribute__((target("avx2"))) inline __m256i HighNibble(__m256i bytes)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+}
+
+// non-zero where input, read after the 32 bytes of previous, is not valid utf-8
+__attribute__((target("avx2"))) __m256i Utf8Errors(__m256i input, __m256i previous)
+{
+    using namespace utf8;
+    const __m256i shifted = _mm256_permute2x128_si256(previous, input, 0x21);
+    const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+    const __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+    const __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+
+    const __m256i byte1_high = Lookup16(HighNibble(prev1),
+                                        // 0___ ascii
+                                        TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+                                        // 10__ continuation
+                                        TwoConts, TwoConts, TwoConts, TwoConts,
+                                        // 1100, 1101 two byte lead
+                                        TooShort | Overlong2, TooShort,
+                                        // 1110 three byte lead, 1111 four byte lead
+                                        TooShort | Overlong3 | Surrogate, TooShort | TooLarge | TooLarge1000 | Overlong4);
+    const __m256i byte1_low = Lookup16(_mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)),
+                                       Carry | Overlong3 | Overlong2 | Overlong4, Carry | Overlong2, Carry, Carry,
+                                       Carry | TooLarge, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                                       Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                                       Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000 | Surrogate, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000);
+    const __m256i byte2_high = Lookup16(HighNibble(input),
+                                        // 0___ ascii
+                                        TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+                                        // 1000, 1001, 101_ continuation
+                                        TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge1000 | Overlong4,
+                                        TooLong | Overlong2 | TwoConts | Overlong3 | TooLarge,
+                                        TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+                                        TooLong | Overlong2 | TwoConts | Surrogate | TooLarge,
+                                        // 11__ lead
+                                        TooShort, TooShort, TooShort, TooShort);
+    const __m256i special = _mm256_and_si256(_mm256_and_si256(byte1_high, byte1_low), byte2_high);
+
+    // continuation bytes expected after 3 and 4 byte leads, which the pair lookups flag as TwoConts
+    const __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m256i expected = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+    return _mm256_xor_si256(expected, special);
+}
+
+__attribute__((target("avx2"))) const char *ValidateUtf8AVX2(const char *begin, const char *end)
+{
+    // a lead byte in the last 3 bytes of a block needs bytes of the next block
+    const __m256i limit = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                           -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                           static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    __m256i previous = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    const char *block = begin;
+    for (; end - block >= 32; block += 32)
+    {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+        __m256i error;
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            error = incomplete;
+            incomplete = _mm256_setzero_si256();
+        }
+        else
+        {
+            error = Utf8Errors(input, previous);
+            incomplete = _mm256_subs_epu8(input, limit);
+        }
+        previous = input;
+        if (!_mm256_testz_si256(error, error))
+        {
+            // locate the error with the scalar decoder
+            break;
+        }
+    }
+    return ValidateUtf8Scalar(Utf8Boundary(begin, block), end);
+}
+
+bool HasAVX2()
+{
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+const Variant &GetDispatch()
+{
+    static const Variant dispatch = Variants().back();
+    return dispatch;
+}
+}  // namespace
+
+const std::vector<Variant> &Variants()
+{
+    static const std::vector<Variant> variants = [] {
+        std::vector<Variant> supported = {{"scalar", SkipBlankScalar, FindFirstOfScalar, ValidateUtf8Scalar}};
+#ifdef CDSCRIPT_SCAN_SSE2
+        supported.push_back({"sse2", SkipBlankSSE2, FindFirstOfSSE2, ValidateUtf8SSE2});
+#endif
+#ifdef CDSCRIPT_SCAN_AVX2
+        if (HasAVX2())
+        {
+            supported.push_back({"avx2", SkipBlankAVX2, FindFirstOfAVX2, ValidateUtf8AVX2});
+        }
+#endif
+        return supported;
+    }();
+    return variants;
+}
+
+const char *SkipBlank(const char *begin, const char *end)
+{
+    return GetDispatch().skip_blank(begin, end);
+}
+
+const char *FindFirstOf(const char *begin, const char *end, char a, char b, char c, char d)
+{
+    return GetDispatch().find_first_of(begin, end, a, b, c, d);
+}
+
+const char *ValidateUtf8(const char *begin, const char *end)
+{
+    return GetDispatch().validate_utf8(begin, end);
+}
+}  // namespace cd::script::scan
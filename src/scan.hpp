@@ -0,0 +1,44 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <vector>
+
+namespace cd::script::scan
+{
+// All functions scan [begin, end) and return end when nothing stops them.
+// The widest instruction set supported by the running cpu is picked on first use.
+
+// first character that is none of ' ' '\t' '\v' '\f' '\0'
+const char *SkipBlank(const char *begin, const char *end);
+
+// first character equal to any of a, b, c, d
+const char *FindFirstOf(const char *begin, const char *end, char a, char b, char c, char d);
+
+// first byte of the first sequence that is not well-formed utf-8, a sequence cut off by end included
+const char *ValidateUtf8(const char *begin, const char *end);
+
+// the functions above built for one instruction set, so tests can run each of them
+struct Variant
+{
+    const char *name;
+    const char *(*skip_blank)(const char *begin, const char *end);
+    const char *(*find_first_of)(const char *begin, const char *end, char a, char b, char c, char d);
+    const char *(*validate_utf8)(const char *begin, const char *end);
+};
+
+// variants the running cpu supports from scalar up, the last one is what the functions above use
+const std::vector<Variant> &Variants();
+
+inline const char *FindFirstOf(const char *begin, const char *end, char a, char b)
+{
+    return FindFirstOf(begin, end, a, b, b, b);
+}
+
+inline const char *FindFirstOf(const char *begin, const char *end, char a, char b, char c)
+{
+    return FindFirstOf(begin, end, a, b, c, c);
+}
+}  // namespace cd::script::scan
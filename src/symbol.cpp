@@ -0,0 +1,37 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "symbol.hpp"
+#include <cstring>
+
+namespace cd::script
+{
+SymbolTable::SymbolTable(std::shared_ptr<std::pmr::memory_resource> _arena)
+    : arena(_arena ? std::move(_arena) : std::make_shared<std::pmr::monotonic_buffer_resource>())
+{
+}
+
+symbol_t SymbolTable::Intern(std::string_view name)
+{
+    auto itr = index.find(name);
+    if (itr != index.end())
+    {
+        return itr->second;
+    }
+    auto symbol = static_cast<symbol_t>(names.size());
+    auto data = static_cast<char *>(arena->allocate(name.size(), 1));
+    std::memcpy(data, name.data(), name.size());
+    std::string_view stored(data, name.size());
+    names.push_back(stored);
+    index.emplace(stored, symbol);
+    return symbol;
+}
+
+symbol_t SymbolTable::Find(std::string_view name) const
+{
+    auto itr = index.find(name);
+    return itr == index.end() ? npos : itr->second;
+}
+}  // namespace cd::script
@@ -0,0 +1,48 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "token.hpp"
+
+namespace cd::script
+{
+// interns names into dense 32-bit ids, name bytes live in arena and stay valid as long as it does,
+// not thread safe, share one table per compilation
+class SymbolTable
+{
+  public:
+    // a table without an arena allocates names from its own
+    explicit SymbolTable(std::shared_ptr<std::pmr::memory_resource> _arena = {});
+    SymbolTable(const SymbolTable &) = delete;
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    symbol_t Intern(std::string_view name);
+
+    // returns the symbol of name, or npos when it was never interned
+    symbol_t Find(std::string_view name) const;
+
+    std::string_view Name(symbol_t symbol) const
+    {
+        return names[symbol];
+    }
+
+    size_t size() const
+    {
+        return names.size();
+    }
+
+    static constexpr symbol_t npos = static_cast<symbol_t>(-1);
+
+  private:
+    std::shared_ptr<std::pmr::memory_resource> arena;
+    std::vector<std::string_view> names;
+    std::unordered_map<std::string_view, symbol_t> index;
+};
+}  // namespace cd::script
@@ -6,6 +6,9 @@
 #pragma once
 #include <any>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
 #include "token.hpp"
 
 namespace cd::script
@@ -18,7 +21,31 @@ class Syntax
     virtual void Visit(Visitor *visitor, std::any &data) = 0;
 };
 
-using syntax_t = std::unique_ptr<Syntax>;
+// deletes nodes made with new, nodes of a SyntaxArena are left to the arena
+struct SyntaxDeleter
+{
+    bool heap = true;
+
+    SyntaxDeleter() = default;
+    SyntaxDeleter(bool _heap)
+        : heap(_heap)
+    {
+    }
+    template <typename T>
+    SyntaxDeleter(const std::default_delete<T> &)
+    {
+    }
+
+    void operator()(Syntax *syntax) const
+    {
+        if (heap)
+        {
+            delete syntax;
+        }
+    }
+};
+
+using syntax_t = std::unique_ptr<Syntax, SyntaxDeleter>;
 #define DECL_VISIT_FUNC() void Visit(Visitor *visitor, std::any &data) override
 
 class BinaryExpression : public Syntax
@@ -45,4 +72,43 @@ class LiteralValue : public Syntax
     DECL_VISIT_FUNC();
 };
 
+// nodes made here are freed together with the arena without running their destructors,
+// so a node may only own other nodes of the same arena besides trivially destructible members
+class SyntaxArena
+{
+  public:
+    template <typename T, typename... Args>
+    syntax_t Make(Args &&...args)
+    {
+        static_assert(std::is_base_of_v<Syntax, T>, "only syntax nodes live in the arena");
+        void *node = resource.allocate(sizeof(T), alignof(T));
+        return syntax_t(new (node) T(std::forward<Args>(args)...), SyntaxDeleter(false));
+    }
+
+  private:
+    std::pmr::monotonic_buffer_resource resource;
+};
+
+// a parsed tree, root views nodes in arena, which releases them all in one go
+struct SyntaxTree
+{
+    std::unique_ptr<SyntaxArena> arena;
+    syntax_t root;
+
+    Syntax *get() const
+    {
+        return root.get();
+    }
+
+    Syntax *operator->() const
+    {
+        return root.get();
+    }
+
+    explicit operator bool() const
+    {
+        return static_cast<bool>(root);
+    }
+};
+
 }  // namespace cd::script
@@ -4,14 +4,15 @@
 // https://opensource.org/licenses/MIT
 
 #pragma once
-#include <any>
 #include <limits>
 #include <map>
 #include <string>
+#include <string_view>
 #include "cdscript.hpp"
 namespace cd::script
 {
-using token_t = int32_t;
+using token_t = int16_t;
+using symbol_t = uint32_t;
 
 template <typename T>
 struct SupportedNumberType
@@ -163,6 +164,15 @@ struct NumberValue
     }
 };
 
+// text is not owned, it points into the source or into the arena of the lexer,
+// symbol is only set for Identifier
+struct TextValue
+{
+    const char *data;
+    uint32_t size;
+    symbol_t symbol;
+};
+
 struct Token
 {
     enum Type
@@ -213,23 +223,40 @@ struct Token
         This,
         Super,
         Any,
+        // malformed input lexed with ErrorMode::Collect, described by a Diagnostic
+        Error,
         EndOfFile,
     };
 
     token_t type = EndOfFile;
-    size_t line = 0;
-    size_t column = 0;
-    std::any value;
+    // a line break lies between the token and the token before it, comments are looked through
+    bool newline = false;
+    // byte offset of the first character from the start of the source,
+    // the lexer maps it to line and column on demand
+    uint32_t offset = 0;
+    // String, Identifier and Comment carry text, Number carries number
+    union Value
+    {
+        TextValue text;
+        NumberValue number;
+    } value = {{nullptr, 0, 0}};
 
-    inline std::string &str()
+    inline std::string_view str() const
     {
-        return std::any_cast<std::string &>(value);
+        return std::string_view(value.text.data, value.text.size);
+    }
+
+    inline symbol_t symbol() const
+    {
+        return value.text.symbol;
     }
 
     inline NumberValue &number()
     {
-        return std::any_cast<NumberValue &>(value);
+        return value.number;
     }
 };
 
+static_assert(sizeof(Token) <= 24, "Token should stay small enough to copy freely");
+
 }  // namespace cd::script
\ No newline at end of file
@@ -0,0 +1,94 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "symbol.hpp"
+#include "token.hpp"
+
+namespace cd::script
+{
+// whole source tokenized into parallel arrays, always terminated by EndOfFile.
+// payload is an index into numbers for Number, into texts for String and Comment,
+// and the symbol for Identifier. offsets are relative to source, the buffer it was lexed from,
+// newlines holds Token::newline as bytes so pushing one is a plain store
+struct TokenStream
+{
+    std::string_view source;
+    std::vector<token_t> types;
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> newlines;
+    std::vector<uint32_t> payloads;
+    std::vector<NumberValue> numbers;
+    std::vector<std::string_view> texts;
+    std::shared_ptr<SymbolTable> symbols;
+    // escaped texts are stored here, so the stream keeps them past the lexer
+    std::shared_ptr<std::pmr::memory_resource> arena;
+
+    size_t size() const
+    {
+        return types.size();
+    }
+
+    void Push(Token &token)
+    {
+        uint32_t payload = 0;
+        switch (token.type)
+        {
+        case Token::Number:
+            payload = static_cast<uint32_t>(numbers.size());
+            numbers.push_back(token.number());
+            break;
+        case Token::String:
+        case Token::Comment:
+            payload = static_cast<uint32_t>(texts.size());
+            texts.push_back(token.str());
+            break;
+        case Token::Identifier:
+            payload = token.symbol();
+            break;
+        default:
+            break;
+        }
+        types.push_back(token.type);
+        offsets.push_back(token.offset);
+        newlines.push_back(token.newline);
+        payloads.push_back(payload);
+    }
+
+    Token operator[](size_t index) const
+    {
+        Token token;
+        token.type = types[index];
+        token.offset = offsets[index];
+        token.newline = newlines[index] != 0;
+        switch (token.type)
+        {
+        case Token::Number:
+            token.value.number = numbers[payloads[index]];
+            break;
+        case Token::String:
+        case Token::Comment:
+        {
+            auto text = texts[payloads[index]];
+            token.value.text = {text.data(), static_cast<uint32_t>(text.size()), 0};
+            break;
+        }
+        case Token::Identifier:
+        {
+            auto name = symbols->Name(payloads[index]);
+            token.value.text = {name.data(), static_cast<uint32_t>(name.size()), payloads[index]};
+            break;
+        }
+        default:
+            break;
+        }
+        return token;
+    }
+};
+}  // namespace cd::script
@@ -0,0 +1,73 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "keyword.hpp"
+
+using namespace cd;
+using namespace script;
+
+static std::vector<std::string> Words()
+{
+    std::vector<std::string> words;
+    const char *identifiers[] = {"a", "index", "value", "i", "result", "count", "ifx", "thiss", "_", "interfaces", "print", "self"};
+    for (int round = 0; round < 64; ++round)
+    {
+        for (const auto &kw : KeyWords)
+        {
+            words.emplace_back(kw.word);
+        }
+        for (const auto identifier : identifiers)
+        {
+            words.emplace_back(identifier);
+            words.emplace_back(identifier);
+        }
+    }
+    return words;
+}
+
+TEST_CASE("KeyWord-Lookup", "[benchmark][keyword]")
+{
+    const auto words = Words();
+    std::unordered_map<std::string, token_t> map;
+    for (const auto &kw : KeyWords)
+    {
+        map.emplace(kw.word, kw.type);
+    }
+
+    for (const auto &word : words)
+    {
+        auto itr = map.find(word);
+        REQUIRE(GetKeyWord(word) == (itr == map.end() ? static_cast<token_t>(Token::Identifier) : itr->second));
+    }
+
+    BENCHMARK("unordered_map<std::string>")
+    {
+        token_t sum = 0;
+        std::string buffer;
+        for (const auto &word : words)
+        {
+            buffer.assign(word);
+            auto itr = map.find(buffer);
+            sum += itr == map.end() ? static_cast<token_t>(Token::Identifier) : itr->second;
+        }
+        return sum;
+    };
+
+    BENCHMARK("perfect hash<std::string_view>")
+    {
+        token_t sum = 0;
+        for (const auto &word : words)
+        {
+            sum += GetKeyWord(word);
+        }
+        return sum;
+    };
+}
@@ -0,0 +1,293 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+// Lexer throughput on generated corpora, one json object per line on stdout:
+//   bench_lexer [--size MiB] [--repeat N] [--samples DIR]
+// every corpus mixes lines of the language samples with generated code of one kind,
+// the best of N runs is reported.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "lexer.hpp"
+#include "utils.hpp"
+
+using namespace cd;
+using namespace script;
+
+#ifndef CDSCRIPT_SAMPLES_DIR
+#define CDSCRIPT_SAMPLES_DIR "language/tests"
+#endif
+
+using Generator = std::function<std::string(std::mt19937 &)>;
+
+struct Corpus
+{
+    std::string name;
+    std::vector<std::string> samples;
+    Generator generate;
+};
+
+static bool Lexes(const std::string &code)
+{
+    try
+    {
+        auto lexer = Lexer::GetLexer(std::string_view(code));
+        while (lexer->GetToken().type != Token::EndOfFile)
+        {
+        }
+        return true;
+    }
+    catch (const Exception &)
+    {
+        return false;
+    }
+}
+
+// lines of the sample files that the lexer accepts on their own
+static std::vector<std::string> SampleLines(const std::string &directory, const std::vector<std::string> &files)
+{
+    std::vector<std::string> lines;
+    for (const auto &file : files)
+    {
+        std::ifstream stream(std::filesystem::path(directory) / file, std::ios::binary);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            if (!line.empty() && Lexes(line))
+            {
+                lines.push_back(line);
+            }
+        }
+    }
+    return lines;
+}
+
+template <typename T>
+static const T &Pick(std::mt19937 &random, const std::vector<T> &items)
+{
+    return items[random() % items.size()];
+}
+
+static std::string Name(std::mt19937 &random)
+{
+    static const std::vector<std::string> stems = {"i", "index", "value", "count", "result", "node", "self_ref", "_tmp", "buffer", "LongerIdentifierName"};
+    auto name = Pick(random, stems);
+    if (random() % 2)
+    {
+        name += std::to_string(random() % 1000);
+    }
+    return name;
+}
+
+static std::string Identifiers(std::mt19937 &random)
+{
+    std::string line = Name(random) + " = " + Name(random);
+    for (auto i = random() % 4; i > 0; --i)
+    {
+        line += "." + Name(random);
+    }
+    line += "(" + Name(random) + ", " + Name(random) + ")[" + Name(random) + "];";
+    return line;
+}
+
+static std::string Numbers(std::mt19937 &random)
+{
+    static const std::vector<std::string> numbers = {
+        "0b1011", "0B1001'0001", "0b1i8", "0b101u16", "0b1111i32", "0b1u64",
+        "0777", "01'777", "017i8", "0123u32", "0777i64",
+        "0", "42", "123456789", "1'000'000", "255u8", "32767i16", "4294967295u32", "9223372036854775807i64",
+        "0xDEADBEEF", "0Xff'ff", "0x7fi8", "0xffffu16", "0xffffffffffffffffu64",
+        "0.5", ".25", "3.1416", "1.", "314.16e-2", "0.31416E1", "1.5f", "3.402823466e+38F", "0x1.8p3", "0x0.1E", "0X1.921FB54442D18P+1", "0x1p-4f",
+    };
+    std::string line = Pick(random, numbers);
+    for (auto i = random() % 6 + 2; i > 0; --i)
+    {
+        line += (random() % 2 ? " + " : ", ") + Pick(random, numbers);
+    }
+    return line + ";";
+}
+
+static std::string Strings(std::mt19937 &random)
+{
+    static const std::vector<std::string> strings = {
+        R"("")", R"("plain text with some words")", R"('single quoted')", R"("escapes \t\n\\ \"quoted\" \x41\101")",
+        R"cds(R"(raw text with "quotes" and \ backslashes)")cds", "R\"sep(raw\nspanning lines )\" still raw)sep\"",
+        R"("a much longer string literal that keeps going for a while without any escapes at all")",
+    };
+    std::string line = Name(random) + " = " + Pick(random, strings);
+    for (auto i = random() % 3; i > 0; --i)
+    {
+        line += " .. " + Pick(random, strings);
+    }
+    return line + ";";
+}
+
+static std::string Comments(std::mt19937 &random)
+{
+    static const std::vector<std::string> comments = {
+        "// short comment",
+        "// a longer line comment explaining what the next statement is about, in plain words",
+        "/* block comment */",
+        "/*\n * documentation block\n * with several lines and * stars **\n */",
+        "/// doc comment with `code` and \"quotes\"",
+    };
+    return Pick(random, comments) + "\n" + Name(random) + ";";
+}
+
+// localized scripts, identifiers, strings and comments in CJK text
+static std::string Localized(std::mt19937 &random)
+{
+    static const std::vector<std::string> names = {"\xE5\x90\x8D\xE5\xAD\x97", "\xE6\x95\xB0\xE9\x87\x8F", "\xE7\xBB\x93\xE6\x9E\x9C", "\xE7\x94\xA8\xE6\x88\xB7_1", "\xE3\x83\x87\xE3\x83\xBC\xE3\x82\xBF"};
+    static const std::vector<std::string> texts = {
+        "\"\xE4\xBD\xA0\xE5\xA5\xBD\xEF\xBC\x8C\xE4\xB8\x96\xE7\x95\x8C\"",
+        "\"\xE8\xBF\x99\xE6\x98\xAF\xE4\xB8\x80\xE6\xAE\xB5\xE6\xAF\x94\xE8\xBE\x83\xE9\x95\xBF\xE7\x9A\x84\xE6\x9C\xAC\xE5\x9C\xB0\xE5\x8C\x96\xE6\x96\x87\xE6\x9C\xAC\xEF\xBC\x8C\xE7\x94\xA8\xE6\x9D\xA5\xE6\xB5\x8B\xE8\xAF\x95\"",
+        "'\xE3\x81\x93\xE3\x82\x93\xE3\x81\xAB\xE3\x81\xA1\xE3\x81\xAF \\u4e16\\u754c'",
+    };
+    std::string line = Pick(random, names) + " = " + Pick(random, texts) + " .. " + Pick(random, names) + ";";
+    if (random() % 3 == 0)
+    {
+        line += " // \xE6\xB3\xA8\xE9\x87\x8A\xEF\xBC\x9A\xE8\xBF\x99\xE4\xB8\x80\xE8\xA1\x8C\xE8\xB5\x8B\xE5\x80\xBC";
+    }
+    return line;
+}
+
+static std::string Generate(const Corpus &corpus, size_t size, std::mt19937 &random)
+{
+    std::string code;
+    code.reserve(size + 256);
+    while (code.size() < size)
+    {
+        if (!corpus.samples.empty() && random() % 4 == 0)
+        {
+            code += Pick(random, corpus.samples);
+        }
+        else
+        {
+            code += corpus.generate(random);
+        }
+        code += random() % 8 ? "\n" : "\r\n";
+    }
+    return code;
+}
+
+struct Result
+{
+    double seconds = 0;
+    size_t tokens = 0;
+};
+
+template <typename Run>
+static Result Measure(int repeat, Run run)
+{
+    Result best;
+    for (int i = 0; i <= repeat; ++i)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        size_t tokens = run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        // the first run only warms up caches
+        if (i == 1 || (i > 1 && elapsed.count() < best.seconds))
+        {
+            best = {elapsed.count(), tokens};
+        }
+    }
+    return best;
+}
+
+static void Report(const std::string &corpus, const char *api, size_t bytes, const Result &result)
+{
+    std::cout << "{\"bench\":\"lexer\",\"corpus\":\"" << corpus << "\",\"api\":\"" << api << "\",\"bytes\":" << bytes
+              << ",\"tokens\":" << result.tokens << ",\"seconds\":" << result.seconds
+              << ",\"mb_per_s\":" << bytes / result.seconds / 1e6 << ",\"tokens_per_s\":" << result.tokens / result.seconds << "}" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t size = 16;
+    int repeat = 5;
+    std::string samples = CDSCRIPT_SAMPLES_DIR;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--size") == 0)
+        {
+            size = std::stoul(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--repeat") == 0)
+        {
+            repeat = std::max(1, std::stoi(argv[i + 1]));
+        }
+        else if (std::strcmp(argv[i], "--samples") == 0)
+        {
+            samples = argv[i + 1];
+        }
+        else
+        {
+            std::cerr << "usage: bench_lexer [--size MiB] [--repeat N] [--samples DIR]" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<Corpus> corpora = {
+        {"identifier", SampleLines(samples, {"assignment.cds", "indexexpr.cds", "functiondef.cds", "statement.cds", "variable.cds"}), Identifiers},
+        {"number", SampleLines(samples, {"integer.cds", "float.cds"}), Numbers},
+        {"string", SampleLines(samples, {"string.cds"}), Strings},
+        {"comment", SampleLines(samples, {"float.cds", "integer.cds"}), Comments},
+        {"localized", SampleLines(samples, {"assignment.cds", "string.cds", "variable.cds"}), Localized},
+        {"mixed", SampleLines(samples, {"assignment.cds", "binaryexpr.cds", "block.cds", "float.cds", "functiondef.cds", "indexexpr.cds", "integer.cds", "statement.cds", "string.cds", "unaryexpr.cds", "variable.cds"}),
+         [](std::mt19937 &random) {
+             switch (random() % 4)
+             {
+             case 0:
+                 return Identifiers(random);
+             case 1:
+                 return Numbers(random);
+             case 2:
+                 return Strings(random);
+             default:
+                 return Comments(random);
+             }
+         }},
+    };
+
+    for (const auto &corpus : corpora)
+    {
+        std::mt19937 random(20190601);
+        const auto code = Generate(corpus, size << 20, random);
+        auto result = Measure(repeat, [&code] {
+            auto lexer = Lexer::GetLexer(std::string_view(code));
+            size_t tokens = 1;
+            while (lexer->GetToken().type != Token::EndOfFile)
+            {
+                ++tokens;
+            }
+            return tokens;
+        });
+        Report(corpus.name, "GetToken", code.size(), result);
+        // what Tokenize replaces, pulling every token and keeping it
+        result = Measure(repeat, [&code] {
+            auto lexer = Lexer::GetLexer(std::string_view(code));
+            std::vector<Token> tokens;
+            do
+            {
+                tokens.push_back(lexer->GetToken());
+            } while (tokens.back().type != Token::EndOfFile);
+            return tokens.size();
+        });
+        Report(corpus.name, "GetToken-Keep", code.size(), result);
+        result = Measure(repeat, [&code] {
+            return Lexer::GetLexer(std::string_view(code))->Tokenize().size();
+        });
+        Report(corpus.name, "Tokenize", code.size(), result);
+    }
+    return 0;
+}
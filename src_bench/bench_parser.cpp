@@ -0,0 +1,128 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+// Parser time and stack use on long generated expressions, one json object per line on stdout:
+//   bench_parser [--terms N] [--repeat N]
+// expressions of 1/100, 1/10 and all of N terms are parsed from a pre-lexed token stream,
+// stack use is the high-water mark of a painted thread stack and should not grow with the terms.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "lexer.hpp"
+#include "parser.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define CDSCRIPT_PAINTED_STACK 1
+#endif
+
+using namespace cd;
+using namespace script;
+
+static std::string Chain(size_t terms)
+{
+    std::string code = "1";
+    for (size_t i = 1; i < terms; ++i)
+    {
+        code += " + 1";
+    }
+    return code;
+}
+
+// climbs through every precedence level and back down, so operators wait on each other
+static std::string Mixed(size_t terms)
+{
+    static const char *operators[] = {"||", "&&", "|", "^", "&", "==", "<", "<<", "+", "*", "-", ">=", "!=", "&", "|"};
+    std::string code = "1";
+    for (size_t i = 1; i < terms; ++i)
+    {
+        code += " ";
+        code += operators[i % std::size(operators)];
+        code += " 1";
+    }
+    return code;
+}
+
+#ifdef CDSCRIPT_PAINTED_STACK
+// bytes of a fresh thread stack that run touched
+static size_t StackUse(const std::function<void()> &run)
+{
+    const size_t size = 64 << 20;
+    const unsigned char paint = 0xA5;
+    std::vector<unsigned char> stack(size, paint);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack.data(), size);
+    pthread_t thread;
+    auto body = [](void *argument) -> void * {
+        (*static_cast<const std::function<void()> *>(argument))();
+        return nullptr;
+    };
+    pthread_create(&thread, &attr, body, const_cast<std::function<void()> *>(&run));
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+    // the stack grows down from the end of the buffer
+    auto untouched = std::find_if(stack.begin(), stack.end(), [paint](unsigned char byte) { return byte != paint; });
+    return static_cast<size_t>(stack.end() - untouched);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    size_t terms = 100000;
+    int repeat = 5;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--terms") == 0)
+        {
+            terms = std::max<size_t>(100, std::stoul(argv[i + 1]));
+        }
+        else if (std::strcmp(argv[i], "--repeat") == 0)
+        {
+            repeat = std::max(1, std::stoi(argv[i + 1]));
+        }
+        else
+        {
+            std::cerr << "usage: bench_parser [--terms N] [--repeat N]" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<std::pair<const char *, std::function<std::string(size_t)>>> shapes = {{"chain", Chain}, {"mixed", Mixed}};
+    for (const auto &[shape, generate] : shapes)
+    {
+        for (size_t count : {terms / 100, terms / 10, terms})
+        {
+            const auto code = generate(count);
+            const auto tokens = Lexer::GetLexer(std::string_view(code))->Tokenize();
+            auto parse = [&tokens] { (void)Parser::GetParser(tokens)->GetAbstractSyntaxTree(); };
+            double best = 0;
+            for (int i = 0; i <= repeat; ++i)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                parse();
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+                // the first run only warms up caches
+                if (i == 1 || (i > 1 && elapsed.count() < best))
+                {
+                    best = elapsed.count();
+                }
+            }
+#ifdef CDSCRIPT_PAINTED_STACK
+            long long stack = static_cast<long long>(StackUse(parse));
+#else
+            long long stack = -1;
+#endif
+            std::cout << "{\"bench\":\"parser\",\"shape\":\"" << shape << "\",\"terms\":" << count << ",\"seconds\":" << best
+                      << ",\"terms_per_s\":" << count / best << ",\"stack_bytes\":" << stack << "}" << std::endl;
+        }
+    }
+    return 0;
+}
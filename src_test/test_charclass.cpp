@@ -0,0 +1,40 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include <cctype>
+#include <clocale>
+#include "catch2_ext.hpp"
+#include "charclass.hpp"
+using namespace cd;
+using namespace script;
+
+TEST_CASE("CharClass-Table", "[core][charclass]")
+{
+    std::setlocale(LC_ALL, "C");
+    for (int ch = 0; ch < 256; ++ch)
+    {
+        auto c = static_cast<char>(ch);
+        INFO("character " << ch);
+        CHECK(charclass::Is(c, charclass::Digit) == (std::isdigit(ch) != 0));
+        CHECK(charclass::Is(c, charclass::XDigit) == (std::isxdigit(ch) != 0));
+        CHECK(charclass::Is(c, charclass::Alpha) == (std::isalpha(ch) != 0));
+        CHECK(charclass::Is(c, charclass::Punct) == (std::ispunct(ch) != 0));
+        CHECK(charclass::Is(c, charclass::IdBody) == (std::isalnum(ch) != 0 || ch == '_' || (ch >= 0x80 && ch < 0xFF)));
+        CHECK(charclass::Is(c, charclass::NonAscii) == (ch >= 0x80 && ch < 0xFF));
+        if (std::isxdigit(ch))
+        {
+            CHECK(charclass::DigitValue[ch] == std::stoi(std::string(1, c), nullptr, 16));
+        }
+        else
+        {
+            CHECK(charclass::DigitValue[ch] == 16);
+        }
+    }
+    CHECK(charclass::Is('\0', charclass::Blank));
+    CHECK(charclass::Is('\v', charclass::Blank));
+    CHECK_FALSE(charclass::Is('\n', charclass::Blank));
+    CHECK(charclass::Is('@', charclass::Disallowed));
+    CHECK_FALSE(charclass::Is('8', charclass::ODigit));
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "catch2_ext.hpp"
+#include "flat_syntax.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+using namespace cd;
+using namespace script;
+
+TEST_CASE("FlatSyntax-Flatten", "[core][parser][flat]")
+{
+    std::string_view code("1 * 2 + \"s\\t\" == true");
+    auto tokens = Lexer::GetLexer(code)->Tokenize();
+    auto ast = Parser::GetParser(tokens)->GetAbstractSyntaxTree();
+    auto flat = FlatSyntaxTree::Flatten(ast.get());
+    REQUIRE(flat.size() == 7);
+    const std::vector<std::tuple<SyntaxKind, token_t, uint32_t>> expected = {
+        {SyntaxKind::LiteralValue, Token::Number, 0},
+        {SyntaxKind::LiteralValue, Token::Number, 4},
+        {SyntaxKind::BinaryExpression, '*', 2},
+        {SyntaxKind::LiteralValue, Token::String, 8},
+        {SyntaxKind::BinaryExpression, '+', 6},
+        {SyntaxKind::LiteralValue, Token::True, 17},
+        {SyntaxKind::BinaryExpression, Token::Equal, 14},
+    };
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        auto [kind, type, offset] = expected[i];
+        CHECK(flat.nodes[i].kind == kind);
+        CHECK(flat.nodes[i].type == type);
+        CHECK(flat.nodes[i].offset == offset);
+    }
+    CHECK(flat.root() == 6);
+    CHECK(flat.nodes[6].first == 4);
+    CHECK(flat.nodes[6].second == 5);
+    CHECK(flat.nodes[4].first == 2);
+    CHECK(flat.nodes[4].second == 3);
+    CHECK(flat.nodes[2].first == 0);
+    CHECK(flat.nodes[2].second == 1);
+    CHECK(flat.Literal(1).number().get<int32_t>() == 2);
+    CHECK(flat.Literal(3).str() == "s\t");
+    CHECK(flat.numbers.size() == 2);
+    CHECK(flat.texts.size() == 1);
+
+    CHECK(FlatSyntaxTree::Flatten(nullptr).size() == 0);
+}
+
+TEST_CASE("FlatSyntax-Pass", "[core][parser][flat]")
+{
+    // operands precede their operator, one forward pass evaluates the tree
+    std::string_view code("1 + 2 * 3 - 8 / 4 % 3");
+    auto tokens = Lexer::GetLexer(code)->Tokenize();
+    auto flat = FlatSyntaxTree::Flatten(Parser::GetParser(tokens)->GetAbstractSyntaxTree().get());
+    std::vector<int32_t> values(flat.size());
+    for (uint32_t i = 0; i < flat.size(); ++i)
+    {
+        const auto &node = flat.nodes[i];
+        if (node.kind == SyntaxKind::LiteralValue)
+        {
+            values[i] = flat.Literal(i).number().get<int32_t>();
+            continue;
+        }
+        auto left = values[node.first], right = values[node.second];
+        switch (node.type)
+        {
+        case '+':
+            values[i] = left + right;
+            break;
+        case '-':
+            values[i] = left - right;
+            break;
+        case '*':
+            values[i] = left * right;
+            break;
+        case '/':
+            values[i] = left / right;
+            break;
+        case '%':
+            values[i] = left % right;
+            break;
+        }
+    }
+    CHECK(values[flat.root()] == 1 + 2 * 3 - 8 / 4 % 3);
+}
+
+TEST_CASE("FlatSyntax-LongExpression", "[core][parser][flat]")
+{
+    // flattening does not recurse either, the chain from Parser-LongExpression fits any stack
+    const size_t terms = 100000;
+    std::string code = "0";
+    for (size_t i = 1; i < terms; ++i)
+    {
+        code += i % 2 ? " + 1" : " - 2";
+    }
+    auto tokens = Lexer::GetLexer(std::string_view(code))->Tokenize();
+    auto ast = Parser::GetParser(tokens)->GetAbstractSyntaxTree();
+    auto flat = FlatSyntaxTree::Flatten(ast.get());
+    REQUIRE(flat.size() == 2 * terms - 1);
+    CHECK(flat.nodes[0].kind == SyntaxKind::LiteralValue);
+    // each operator follows its right operand and takes the previous operator as left operand
+    for (uint32_t i = 2; i < flat.size(); i += 2)
+    {
+        const auto &node = flat.nodes[i];
+        REQUIRE(node.kind == SyntaxKind::BinaryExpression);
+        CHECK(node.type == (i / 2 % 2 ? '+' : '-'));
+        CHECK(node.first == i - 2);
+        CHECK(node.second == i - 1);
+    }
+    CHECK(flat.root() == 2 * terms - 2);
+}
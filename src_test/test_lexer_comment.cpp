@@ -82,4 +82,56 @@ TEST_CASE("Lexer-Comment-MultiLine", "[core][lexer][comment]")
         auto lexer = Lexer::GetLexer(code);
         CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("comment unclosed at <eof>"));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lexer-Comment-Long", "[core][lexer][comment]")
+{
+    {
+        std::string body(100, '-');
+        std::istringstream code("//" + body + "\r\n/*" + body + "*\n" + body + "**/" + std::string(70, ' ') + "x");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::Comment);
+        CHECK(token.str() == body);
+        token = lexer->GetToken();
+        CHECK(token.type == Token::Comment);
+        CHECK(token.str() == body + "*\n" + body + "*");
+        token = lexer->GetToken();
+        CHECK(token.type == Token::Identifier);
+        CHECK(token.offset == 381);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 3);
+        CHECK(location.column == 174);
+    }
+}
+
+TEST_CASE("Lexer-Comment-Skip", "[core][lexer][comment]")
+{
+    LexerOptions options;
+    options.comments = CommentMode::Skip;
+    {
+        std::istringstream code("// line\na /* block\n */ = b // tail");
+        auto lexer = Lexer::GetLexer(code, options);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::Identifier);
+        CHECK(token.str() == "a");
+        CHECK(lexer->GetToken().type == '=');
+        token = lexer->GetToken();
+        CHECK(token.type == Token::Identifier);
+        CHECK(token.offset == 25);
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+    {
+        auto lexer = Lexer::GetLexer(std::string_view("/**/1/*2*/3//4"), options);
+        auto stream = lexer->Tokenize();
+        CHECK(stream.types == std::vector<token_t>{Token::Number, Token::Number, Token::EndOfFile});
+        CHECK(stream.offsets == std::vector<uint32_t>{4, 10, 14});
+        CHECK(stream.texts.empty());
+    }
+    {
+        std::istringstream code("a /* open");
+        auto lexer = Lexer::GetLexer(code, options);
+        CHECK(lexer->GetToken().type == Token::Identifier);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("comment unclosed at <eof>"));
+    }
+}
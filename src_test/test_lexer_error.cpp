@@ -0,0 +1,163 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include <sstream>
+#include "catch2_ext.hpp"
+#include "lexer.hpp"
+using namespace cd;
+using namespace script;
+
+static const std::string code = "a = 0x;\nb = \"bad \\q escape\" + 1;\nc = 12u7 @ d\n\"open\ne = 1.5e;\n/* never closed";
+
+static LexerOptions Collect()
+{
+    LexerOptions options;
+    options.errors = ErrorMode::Collect;
+    return options;
+}
+
+static void CheckDiagnostics(const std::vector<Diagnostic> &diagnostics)
+{
+    REQUIRE(diagnostics.size() == 5);
+    CHECK(diagnostics[0].offset == 18);
+    CHECK(diagnostics[0].message == R"#(unexpected character after '\' line:2 column:11)#");
+    CHECK(diagnostics[1].offset == 41);
+    CHECK(diagnostics[1].message == "unexpected postfix bit after number literal at line:3 column:9");
+    CHECK(diagnostics[2].offset == 51);
+    CHECK(diagnostics[2].message == "incomplete string at line:4 column:6");
+    CHECK(diagnostics[3].offset == 60);
+    CHECK(diagnostics[3].message == "expect exponent digit at line:5 column:9");
+    CHECK(diagnostics[4].offset == 77);
+    CHECK(diagnostics[4].message == "comment unclosed at <eof>");
+}
+
+TEST_CASE("Lexer-Error-Collect", "[core][lexer][error]")
+{
+    const std::vector<std::pair<token_t, uint32_t>> expected = {
+        {Token::Identifier, 0}, {'=', 2}, {Token::Number, 4}, {';', 6},
+        {Token::Identifier, 8}, {'=', 10}, {Token::Error, 12}, {'+', 28}, {Token::Number, 30}, {';', 31},
+        {Token::Identifier, 33}, {'=', 35}, {Token::Error, 37}, {'@', 42}, {Token::Identifier, 44},
+        {Token::Error, 46},
+        {Token::Identifier, 52}, {'=', 54}, {Token::Error, 56}, {';', 60},
+        {Token::Error, 62},
+        {Token::EndOfFile, 77},
+    };
+
+    SECTION("GetToken")
+    {
+        auto lexer = Lexer::GetLexer(std::string_view(code), Collect());
+        for (auto [type, offset] : expected)
+        {
+            auto token = lexer->GetToken();
+            CHECK(token.type == type);
+            CHECK(token.offset == offset);
+        }
+        CheckDiagnostics(lexer->GetDiagnostics());
+    }
+
+    SECTION("Tokenize")
+    {
+        auto lexer = Lexer::GetLexer(std::string_view(code), Collect());
+        auto stream = lexer->Tokenize();
+        REQUIRE(stream.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            CHECK(stream[i].type == expected[i].first);
+            CHECK(stream[i].offset == expected[i].second);
+        }
+        CheckDiagnostics(lexer->GetDiagnostics());
+    }
+
+    SECTION("Stream")
+    {
+        std::istringstream input(code);
+        auto lexer = Lexer::GetStreamingLexer(input, 3, Collect());
+        for (auto [type, offset] : expected)
+        {
+            auto token = lexer->GetToken();
+            CHECK(token.type == type);
+            CHECK(token.offset == offset);
+        }
+        CheckDiagnostics(lexer->GetDiagnostics());
+    }
+}
+
+TEST_CASE("Lexer-Error-Throw", "[core][lexer][error]")
+{
+    // the default mode stops at the first error with the message Collect reports for it
+    auto lexer = Lexer::GetLexer(std::string_view(code));
+    for (int i = 0; i < 6; ++i)
+    {
+        (void)lexer->GetToken();
+    }
+    CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals(R"#(unexpected character after '\' line:2 column:11)#"));
+    CHECK(lexer->GetDiagnostics().empty());
+}
+
+TEST_CASE("Lexer-Error-Threads", "[core][lexer][error]")
+{
+    // chunks start at line starts, the second pattern puts an error token at every chunk start
+    for (auto line : {"value = 1.5e + \"text\\q\" + 0b102;\nname = 'ok' .. 3;\n", "1.5e + \"text\\q\" + 0b102;\n\"open\n"})
+    {
+        std::string large;
+        while (large.size() < 512 * 1024)
+        {
+            large += line;
+        }
+        auto options = Collect();
+        auto serial = Lexer::GetLexer(std::string_view(large), options);
+        auto expected = serial->Tokenize();
+        options.threads = 4;
+        auto parallel = Lexer::GetLexer(std::string_view(large), options);
+        auto stream = parallel->Tokenize();
+        REQUIRE(stream.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            REQUIRE(stream[i].type == expected[i].type);
+            REQUIRE(stream[i].offset == expected[i].offset);
+        }
+        auto &left = serial->GetDiagnostics();
+        auto &right = parallel->GetDiagnostics();
+        REQUIRE(left.size() == right.size());
+        CHECK(!left.empty());
+        for (size_t i = 0; i < left.size(); ++i)
+        {
+            CHECK(left[i].offset == right[i].offset);
+            CHECK(left[i].message == right[i].message);
+        }
+    }
+}
+
+TEST_CASE("Lexer-Error-Utf8", "[core][lexer][error]")
+{
+    // stray continuation, overlong, surrogate, truncated sequence and a 0xFF byte
+    const std::string utf8 = "a\x80 = \"\xC0\xAF\";\n// \xED\xA0\x80\n/* \xE4\xB8 */ b \xFF c";
+    const std::vector<std::pair<token_t, uint32_t>> expected = {
+        {Token::Error, 0}, {'=', 3}, {Token::Error, 5}, {';', 9}, {Token::Error, 11}, {Token::Error, 18}, {Token::Identifier, 27}, {Token::Error, 29}, {Token::Identifier, 31}, {Token::EndOfFile, 32},
+    };
+    for (auto mode : {CommentMode::Keep, CommentMode::Skip})
+    {
+        auto options = Collect();
+        options.comments = mode;
+        auto lexer = Lexer::GetLexer(std::string_view(utf8), options);
+        for (auto [type, offset] : expected)
+        {
+            auto token = lexer->GetToken();
+            CHECK(token.type == type);
+            CHECK(token.offset == offset);
+        }
+        auto &diagnostics = lexer->GetDiagnostics();
+        REQUIRE(diagnostics.size() == 5);
+        CHECK(diagnostics[0].offset == 1);
+        CHECK(diagnostics[0].message == "invalid utf-8 sequence at line:1 column:2");
+        CHECK(diagnostics[1].offset == 6);
+        CHECK(diagnostics[2].offset == 14);
+        CHECK(diagnostics[3].offset == 21);
+        CHECK(diagnostics[4].offset == 29);
+        CHECK(diagnostics[4].message == "invalid utf-8 sequence at line:3 column:12");
+    }
+    auto lexer = Lexer::GetLexer(std::string_view(utf8));
+    CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("invalid utf-8 sequence at line:1 column:2"));
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "catch2_ext.hpp"
+#include "lexer.hpp"
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+using namespace cd;
+using namespace script;
+
+static std::string WriteTempFile(const std::string &name, const std::string &content)
+{
+    auto path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+    return path;
+}
+
+TEST_CASE("Lexer-File", "[core][lexer][file]")
+{
+    {
+        auto path = WriteTempFile("cdscript_lexer_file.cds", "abc = \"def\" // tail\n1.5");
+        {
+            auto lexer = Lexer::GetLexerFromFile(path);
+            auto token = lexer->GetToken();
+            CHECK(token.type == Token::Identifier);
+            CHECK(token.str() == "abc");
+            CHECK(lexer->GetToken().type == '=');
+            token = lexer->GetToken();
+            CHECK(token.type == Token::String);
+            CHECK(token.str() == "def");
+            token = lexer->GetToken();
+            CHECK(token.type == Token::Comment);
+            CHECK(token.str() == " tail");
+            token = lexer->GetToken();
+            CHECK(token.type == Token::Number);
+            CHECK(token.number().get<double>() == 1.5);
+            token = lexer->GetToken();
+            CHECK(token.type == Token::EndOfFile);
+            CHECK(lexer->GetLocation(token.offset).line == 2);
+        }
+        std::filesystem::remove(path);
+    }
+    {
+        auto path = WriteTempFile("cdscript_lexer_empty.cds", "");
+        {
+            auto lexer = Lexer::GetLexerFromFile(path);
+            CHECK(lexer->GetToken().type == Token::EndOfFile);
+        }
+        std::filesystem::remove(path);
+    }
+    {
+        auto path = (std::filesystem::temp_directory_path() / "cdscript_lexer_missing.cds").string();
+        CHECK_THROWS_MATCHES(Lexer::GetLexerFromFile(path), Exception, WhatEquals("can not open file:" + path));
+    }
+}
+
+TEST_CASE("Lexer-File-Special", "[core][lexer][file]")
+{
+    {
+        // sparse, so the test does not write 4 GiB
+        auto path = WriteTempFile("cdscript_lexer_large.cds", "");
+        std::filesystem::resize_file(path, (uint64_t(1) << 32) + 1);
+        CHECK_THROWS_MATCHES(Lexer::GetLexerFromFile(path), Exception, WhatEquals("file too large:" + path));
+        std::filesystem::remove(path);
+    }
+    if constexpr (sizeof(size_t) > sizeof(uint32_t))
+    {
+        // in-memory sources have the same limit, the view is never read
+        const char byte = 0;
+        std::string_view huge(&byte, static_cast<size_t>(std::numeric_limits<uint32_t>::max()) + 1);
+        CHECK_THROWS_MATCHES(Lexer::GetLexer(huge), Exception, WhatEquals("source too large: more than 4294967295 bytes"));
+    }
+#if !defined(_WIN32)
+    {
+        // a pipe has no size, its content is read instead of mapped
+        auto path = (std::filesystem::temp_directory_path() / "cdscript_lexer_fifo").string();
+        std::filesystem::remove(path);
+        REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+        std::thread writer([&path] { std::ofstream(path, std::ios::binary) << "piped 42"; });
+        auto lexer = Lexer::GetLexerFromFile(path);
+        writer.join();
+        CHECK(lexer->GetToken().str() == "piped");
+        CHECK(lexer->GetToken().type == Token::Number);
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+        std::filesystem::remove(path);
+    }
+#endif
+#if defined(__linux__)
+    {
+        // procfs files report size 0 but are not empty
+        auto lexer = Lexer::GetLexerFromFile("/proc/self/status");
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::Identifier);
+        CHECK(token.str() == "Name");
+    }
+#endif
+}
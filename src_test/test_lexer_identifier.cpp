@@ -22,4 +22,26 @@ TEST_CASE("Lexer-Identifier", "[core][lexer][newline]")
         auto lexer = Lexer::GetLexer(code);
         CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("unexpected character :'\a' line:1 column:1"));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lexer-Identifier-Utf8", "[core][lexer][identifier]")
+{
+    const std::string code = "\xE5\x90\x8D\xE5\xAD\x97 = caf\xC3\xA9_1 + \xF0\x9F\x98\x80\xE5\x90\x8D\xE5\xAD\x97;";
+    auto lexer = Lexer::GetLexer(std::string_view(code));
+    auto token = lexer->GetToken();
+    CHECK(token.type == Token::Identifier);
+    CHECK(token.str() == "\xE5\x90\x8D\xE5\xAD\x97");
+    auto name = token.value.text.symbol;
+    CHECK(lexer->GetToken().type == '=');
+    token = lexer->GetToken();
+    CHECK(token.type == Token::Identifier);
+    CHECK(token.str() == "caf\xC3\xA9_1");
+    CHECK(lexer->GetToken().type == '+');
+    token = lexer->GetToken();
+    CHECK(token.type == Token::Identifier);
+    CHECK(token.offset == 19);
+    CHECK(token.str() == "\xF0\x9F\x98\x80\xE5\x90\x8D\xE5\xAD\x97");
+    CHECK(token.value.text.symbol != name);
+    CHECK(lexer->GetToken().type == ';');
+    CHECK(lexer->GetToken().type == Token::EndOfFile);
+}
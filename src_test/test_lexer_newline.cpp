@@ -14,56 +14,63 @@ TEST_CASE("Lexer-NewLine", "[core][lexer][newline]")
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 1);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 1);
+        CHECK(location.column == 0);
     }
     {
         std::istringstream code("    ");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 1);
-        CHECK(token.column == 4);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 1);
+        CHECK(location.column == 4);
     }
     {
         std::istringstream code("\n");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 2);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 2);
+        CHECK(location.column == 0);
     }
     {
         std::istringstream code("\n ");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 2);
-        CHECK(token.column == 1);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 2);
+        CHECK(location.column == 1);
     }
     {
         std::istringstream code("\n\r");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 2);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 2);
+        CHECK(location.column == 0);
     }
     {
         std::istringstream code("\r\n");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 2);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 2);
+        CHECK(location.column == 0);
     }
     {
         std::istringstream code("\n\n \n");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 4);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 4);
+        CHECK(location.column == 0);
     }
 
     {
@@ -71,23 +78,87 @@ TEST_CASE("Lexer-NewLine", "[core][lexer][newline]")
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 4);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 4);
+        CHECK(location.column == 0);
     }
     {
         std::istringstream code("\r\r \n");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 4);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 4);
+        CHECK(location.column == 0);
     }
     {
         std::istringstream code("\n\n \r");
         auto lexer = Lexer::GetLexer(code);
         auto token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
-        CHECK(token.line == 4);
-        CHECK(token.column == 0);
+        auto location = lexer->GetLocation(token.offset);
+        CHECK(location.line == 4);
+        CHECK(location.column == 0);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lexer-Location", "[core][lexer][newline]")
+{
+    {
+        std::istringstream code("a\r\n  bc\n\rd\n");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.offset == 0);
+        CHECK(lexer->GetLocation(token.offset).line == 1);
+        CHECK(lexer->GetLocation(token.offset).column == 1);
+        token = lexer->GetToken();
+        CHECK(token.offset == 5);
+        CHECK(lexer->GetLocation(token.offset).line == 2);
+        CHECK(lexer->GetLocation(token.offset).column == 3);
+        token = lexer->GetToken();
+        CHECK(token.offset == 9);
+        CHECK(lexer->GetLocation(token.offset).line == 3);
+        CHECK(lexer->GetLocation(token.offset).column == 1);
+        token = lexer->GetToken();
+        CHECK(token.type == Token::EndOfFile);
+        CHECK(token.offset == 11);
+        CHECK(lexer->GetLocation(token.offset).line == 4);
+        CHECK(lexer->GetLocation(token.offset).column == 0);
+    }
+    {
+        std::istringstream code("x\r\n\r\n  \"\n\"");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK(lexer->GetToken().type == Token::Identifier);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("incomplete string at line:3 column:4"));
+    }
+}
+
+TEST_CASE("Lexer-NewLine-Flag", "[core][lexer][newline]")
+{
+    const std::string code = "a b\r\nc /* x\n */ d /* y */ e // z\n\n f\n";
+    const std::vector<uint8_t> keep = {0, 0, 1, 0, 1, 0, 0, 0, 1, 1};
+    const std::vector<uint8_t> skip = {0, 0, 1, 1, 0, 1, 1};
+    for (auto [mode, expected] : {std::make_pair(CommentMode::Keep, keep), std::make_pair(CommentMode::Skip, skip)})
+    {
+        LexerOptions options;
+        options.comments = mode;
+        CHECK(Lexer::GetLexer(std::string_view(code), options)->Tokenize().newlines == expected);
+        for (size_t chunk : {1, 2, 4096})
+        {
+            INFO("chunk " << chunk);
+            std::istringstream input(code);
+            auto lexer = Lexer::GetStreamingLexer(input, chunk, options);
+            std::vector<uint8_t> newlines;
+            while (true)
+            {
+                auto token = lexer->GetToken();
+                newlines.push_back(token.newline);
+                if (token.type == Token::EndOfFile)
+                {
+                    break;
+                }
+            }
+            CHECK(newlines == expected);
+        }
+    }
+}
@@ -476,4 +476,51 @@ TEST_CASE("Lexer-Number-Dec-Hex-Exceptions", "[core][lexer][number]")
         auto lexer = Lexer::GetLexer(code);
         CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("number literal is out of range at line:1 column:24"));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lexer-Number-Separator", "[core][lexer][number]")
+{
+    {
+        std::istringstream code("0B1001'0001 0'17 1'000'000 0xFF'FFu16 1'000.5 1'0e1f");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.number().get<int32_t>() == 145);
+        token = lexer->GetToken();
+        CHECK(token.number().get<int32_t>() == 17);
+        token = lexer->GetToken();
+        CHECK(token.number().get<int32_t>() == 1000000);
+        token = lexer->GetToken();
+        CHECK(token.number().get<uint16_t>() == 0xFFFF);
+        token = lexer->GetToken();
+        CHECK(token.number().get<double>() == 1000.5);
+        token = lexer->GetToken();
+        CHECK(token.number().get<float>() == 100.0f);
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+    {
+        std::istringstream code("1'a'");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK(lexer->GetToken().number().get<int32_t>() == 1);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::String);
+        CHECK(token.str() == "a");
+    }
+}
+
+TEST_CASE("Lexer-Number-Followed", "[core][lexer][number]")
+{
+    {
+        std::istringstream code("0b1+07-1");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK(lexer->GetToken().number().get<int32_t>() == 1);
+        CHECK(lexer->GetToken().type == '+');
+        CHECK(lexer->GetToken().number().get<int32_t>() == 7);
+        CHECK(lexer->GetToken().type == '-');
+        CHECK(lexer->GetToken().number().get<int32_t>() == 1);
+    }
+    {
+        std::istringstream code("08");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("unexpected digit '8' in octal number literal at line:1 column:2"));
+    }
+}
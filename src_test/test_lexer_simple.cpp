@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include "catch2_ext.hpp"
 #include "lexer.hpp"
+#include "operator.hpp"
 using namespace cd;
 using namespace script;
 TEST_CASE("Lexer-SingleToken", "[core][lexer][simple]")
@@ -78,6 +79,28 @@ TEST_CASE("Lexer-XXToken", "[core][lexer][simple]")
     CHECK(lexer->GetToken().type == Token::Or);
 }
 
+TEST_CASE("Lexer-Operators", "[core][lexer][simple]")
+{
+    for (auto &&op : Operators)
+    {
+        if (op.type < 0)
+        {
+            continue;
+        }
+        // the longest match stops at the identifier, also when input arrives a byte at a time
+        std::string text = std::string(op.text) + "a";
+        std::istringstream code(text);
+        auto lexer = Lexer::GetStreamingLexer(code, 1);
+        auto token = lexer->GetToken();
+        CHECK(token.type == op.type);
+        CHECK(token.offset == 0);
+        token = lexer->GetToken();
+        CHECK(token.type == Token::Identifier);
+        CHECK(token.offset == op.text.size());
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+}
+
 TEST_CASE("Lexer-KeyWords", "[core][lexer][simple]")
 {
     std::unordered_map<std::string, token_t> KeyWords = {
@@ -111,4 +134,36 @@ TEST_CASE("Lexer-KeyWords", "[core][lexer][simple]")
         auto lexer = Lexer::GetLexer(code);
         CHECK(lexer->GetToken().type == i.second);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lexer-StringView", "[core][lexer][simple]")
+{
+    {
+        std::string_view code("a + 1 // tail");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::Identifier);
+        CHECK(token.str() == "a");
+        CHECK(lexer->GetToken().type == '+');
+        CHECK(lexer->GetToken().type == Token::Number);
+        token = lexer->GetToken();
+        CHECK(token.type == Token::Comment);
+        CHECK(token.str() == " tail");
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+    {
+        std::string code("x\0y", 3);
+        auto lexer = Lexer::GetLexer(std::string_view(code).substr(0, 2));
+        CHECK(lexer->GetToken().str() == "x");
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+    {
+        // a temporary string is kept by the lexer, a literal is viewed in place
+        auto lexer = Lexer::GetLexer(std::string("a_name_past_the_small_string_buffer = \"text\""));
+        CHECK(lexer->GetToken().str() == "a_name_past_the_small_string_buffer");
+        CHECK(lexer->GetToken().type == '=');
+        CHECK(lexer->GetToken().str() == "text");
+        lexer = Lexer::GetLexer("b");
+        CHECK(lexer->GetToken().str() == "b");
+    }
+}
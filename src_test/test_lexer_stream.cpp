@@ -0,0 +1,130 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include <sstream>
+#include <streambuf>
+#include "catch2_ext.hpp"
+#include "lexer.hpp"
+using namespace cd;
+using namespace script;
+
+// serves the same line over and over without ever holding more than that line
+class RepeatBuffer : public std::streambuf
+{
+    std::string line;
+    size_t left;
+
+  public:
+    size_t served = 0;
+
+    RepeatBuffer(std::string _line, size_t count) : line(std::move(_line)), left(count) {}
+
+  protected:
+    int_type underflow() override
+    {
+        if (left == 0)
+        {
+            return traits_type::eof();
+        }
+        --left;
+        served += line.size();
+        setg(line.data(), line.data(), line.data() + line.size());
+        return traits_type::to_int_type(line[0]);
+    }
+};
+
+TEST_CASE("Lexer-Stream", "[core][lexer][stream]")
+{
+    const std::string code = "abc = \"s\\t\" + 0x1F /* c\r\n */ 1'000\r\nif (x <= 1.5e3) { f(R\"(r\n)\", ...) } // t\n\n0b101u8 'q'";
+    auto expected = Lexer::GetLexer(std::string_view(code));
+    std::vector<Token> tokens;
+    std::vector<std::string> texts;
+    while (true)
+    {
+        tokens.push_back(expected->GetToken());
+        auto type = tokens.back().type;
+        texts.emplace_back(type == Token::String || type == Token::Comment || type == Token::Identifier ? tokens.back().str() : "");
+        if (tokens.back().type == Token::EndOfFile)
+        {
+            break;
+        }
+    }
+    for (size_t chunk : {1, 2, 3, 5, 4096})
+    {
+        INFO("chunk " << chunk);
+        std::istringstream input(code);
+        auto lexer = Lexer::GetStreamingLexer(input, chunk);
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            auto token = lexer->GetToken();
+            REQUIRE(token.type == tokens[i].type);
+            CHECK(token.offset == tokens[i].offset);
+            CHECK(token.newline == tokens[i].newline);
+            if (!texts[i].empty())
+            {
+                CHECK(token.str() == texts[i]);
+            }
+            auto location = lexer->GetLocation(token.offset);
+            auto location_expected = expected->GetLocation(tokens[i].offset);
+            CHECK(location.line == location_expected.line);
+            CHECK(location.column == location_expected.column);
+        }
+        std::istringstream again(code);
+        lexer = Lexer::GetStreamingLexer(again, chunk);
+        auto stream = lexer->Tokenize();
+        auto whole = Lexer::GetLexer(std::string_view(code))->Tokenize();
+        CHECK(stream.offsets == whole.offsets);
+        CHECK(stream.newlines == whole.newlines);
+        CHECK(stream[2].str() == "s\t");
+        CHECK(stream[5].str() == " c\r\n ");
+    }
+    {
+        std::istringstream input("a\r\n\r\n  1'2'");
+        auto lexer = Lexer::GetStreamingLexer(input, 1);
+        CHECK(lexer->GetToken().type == Token::Identifier);
+        CHECK(lexer->GetToken().number().get<int32_t>() == 12);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("incomplete string at <eof>"));
+    }
+    {
+        std::istringstream input("x\n\n \"abc\n");
+        auto lexer = Lexer::GetStreamingLexer(input, 2);
+        CHECK(lexer->GetToken().type == Token::Identifier);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("incomplete string at line:3 column:6"));
+    }
+    {
+        std::istringstream input("/*" + std::string(1 << 20, '*') + "*/x");
+        auto lexer = Lexer::GetStreamingLexer(input, 64);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::Comment);
+        CHECK(token.str().size() == (1 << 20));
+        CHECK(lexer->GetToken().offset == (1 << 20) + 4);
+    }
+}
+
+TEST_CASE("Lexer-Stream-Bounded", "[core][lexer][stream]")
+{
+    const std::string line = "value_name = \"some text\" + 12.5 // note\n";
+    const size_t count = 100000;
+    const size_t chunk = 4096;
+    RepeatBuffer buffer(line, count);
+    std::istream input(&buffer);
+    auto lexer = Lexer::GetStreamingLexer(input, chunk);
+    size_t tokens = 0;
+    size_t ahead = 0;
+    while (true)
+    {
+        auto token = lexer->GetToken();
+        ahead = std::max(ahead, buffer.served - token.offset);
+        if (token.type == Token::EndOfFile)
+        {
+            break;
+        }
+        ++tokens;
+    }
+    CHECK(tokens == count * 6);
+    CHECK(buffer.served == line.size() * count);
+    CHECK(ahead <= 2 * chunk + line.size());
+    CHECK_THROWS_MATCHES(lexer->GetLocation(0), Exception, WhatEquals("offset 0 is no longer buffered"));
+}
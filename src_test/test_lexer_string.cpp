@@ -70,6 +70,22 @@ TEST_CASE("Lexer-String-EscapeCharacter", "[core][lexer][string]")
         token = lexer->GetToken();
         CHECK(token.type == Token::EndOfFile);
     }
+    {
+        std::istringstream code(R"#("\u4e2d\u6587 \U0001F600\u00E9\u0041 \U0010FFFF")#");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::String);
+        CHECK(token.str() == "\xE4\xB8\xAD\xE6\x96\x87 \xF0\x9F\x98\x80\xC3\xA9" "A \xF4\x8F\xBF\xBF");
+        token = lexer->GetToken();
+        CHECK(token.type == Token::EndOfFile);
+    }
+    {
+        std::istringstream code("'\xE4\xB8\xAD\xE6\x96\x87'");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::String);
+        CHECK(token.str() == "\xE4\xB8\xAD\xE6\x96\x87");
+    }
 }
 
 TEST_CASE("Lexer-String-Exception", "[core][lexer][string]")
@@ -109,6 +125,26 @@ TEST_CASE("Lexer-String-Exception", "[core][lexer][string]")
         auto lexer = Lexer::GetLexer(code);
         CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals(R"#(unexpected character after '\' line:1 column:3)#"));
     }
+    {
+        std::istringstream code(R"#("\u12g4")#");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals(R"#(unexpected character after '\u' line:1 column:6)#"));
+    }
+    {
+        std::istringstream code(R"#("\uD800")#");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals(R"#(invalid universal character name \uD800 line:1 column:8)#"));
+    }
+    {
+        std::istringstream code(R"#("\U00110000")#");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals(R"#(invalid universal character name \U00110000 line:1 column:12)#"));
+    }
+    {
+        std::istringstream code("'ab\xC3('");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("invalid utf-8 sequence at line:1 column:4"));
+    }
 }
 
 TEST_CASE("Lexer-String-Raw", "[core][lexer][string]")
@@ -149,4 +185,48 @@ TEST_CASE("Lexer-String-Raw", "[core][lexer][string]")
         auto lexer = Lexer::GetLexer(code);
         CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals(R"#(incomplete raw string at <eof>)#"));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Lexer-String-Long", "[core][lexer][string]")
+{
+    std::string body(100, 'x');
+    {
+        std::istringstream code("\"" + body + "\\n" + body + "'\" '" + body + "\"'");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::String);
+        CHECK(token.str() == body + "\n" + body + "'");
+        token = lexer->GetToken();
+        CHECK(token.type == Token::String);
+        CHECK(token.str() == body + "\"");
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+    {
+        std::istringstream code("\"" + body + "\n\"");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK_THROWS_MATCHES(lexer->GetToken(), Exception, WhatEquals("incomplete string at line:1 column:102"));
+    }
+    {
+        std::istringstream code("R\"-(" + body + ")" + body + ")-\"");
+        auto lexer = Lexer::GetLexer(code);
+        auto token = lexer->GetToken();
+        CHECK(token.type == Token::String);
+        CHECK(token.str() == body + ")" + body);
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+}
+
+TEST_CASE("Lexer-String-InPlace", "[core][lexer][string]")
+{
+    std::string_view code(R"#("plain" "esc\t" R"(raw)")#");
+    auto lexer = Lexer::GetLexer(code);
+    auto token = lexer->GetToken();
+    CHECK(token.str() == "plain");
+    CHECK(token.str().data() == code.data() + 1);
+    token = lexer->GetToken();
+    CHECK(token.str() == "esc\t");
+    CHECK((token.str().data() < code.data() || token.str().data() >= code.data() + code.size()));
+    token = lexer->GetToken();
+    CHECK(token.str() == "raw");
+    CHECK(token.str().data() == code.data() + 19);
+}
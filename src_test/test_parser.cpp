@@ -125,4 +125,272 @@ TEST_CASE("Parser-Comment", "[core][parser]")
         auto parser = Parser::GetParser(lexer);
         REQUIRE_NOTHROW(parser->GetAbstractSyntaxTree());
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Parser-TokenStream", "[core][parser]")
+{
+    for (auto source : {"1", "1 + 1 * 2", "1 * 1 + 2", "/* a */ 1 // b\n * 2 // c", "1 * 2 / 3 % 4 << 5 >> 6 < 7 > 8 <= 9 >= 10 == 11 != 12 & 13 ^ 14 | 15 && 16 || 17"})
+    {
+        std::list<int> expected;
+        {
+            std::istringstream code(source);
+            auto lexer = Lexer::GetLexer(code);
+            auto parser = Parser::GetParser(lexer);
+            auto ast = parser->GetAbstractSyntaxTree();
+            std::any data = &expected;
+            TestVisitor visitor;
+            ast->Visit(&visitor, data);
+        }
+        std::istringstream code(source);
+        auto lexer = Lexer::GetLexer(code);
+        auto tokens = lexer->Tokenize();
+        auto parser = Parser::GetParser(tokens);
+        auto ast = parser->GetAbstractSyntaxTree();
+        std::list<int> types;
+        std::any data = &types;
+        TestVisitor visitor;
+        ast->Visit(&visitor, data);
+        CHECK(types == expected);
+    }
+}
+
+TEST_CASE("Parser-Arena", "[core][parser]")
+{
+    {
+        // deep chains are released without recursing through destructors
+        SyntaxTree tree{std::make_unique<SyntaxArena>(), nullptr};
+        tree.root = tree.arena->Make<LiteralValue>(Token());
+        for (int i = 0; i < 1000000; ++i)
+        {
+            tree.root = tree.arena->Make<BinaryExpression>(std::move(tree.root), tree.arena->Make<LiteralValue>(Token()), Token());
+        }
+        CHECK(dynamic_cast<BinaryExpression *>(tree.get()) != nullptr);
+    }
+    {
+        // nodes made outside an arena are still owned by their handle
+        syntax_t heap = std::make_unique<BinaryExpression>(std::make_unique<LiteralValue>(Token()), std::make_unique<LiteralValue>(Token()), Token());
+        std::list<int> types;
+        std::any data = &types;
+        TestVisitor visitor;
+        heap->Visit(&visitor, data);
+        CHECK(types == std::list<int>{1, 0, 0});
+    }
+}
+
+TEST_CASE("Parser-LongExpression", "[core][parser]")
+{
+    // parsing no longer recurses per operator, the chain stays left associative
+    const size_t terms = 100000;
+    std::string code = "0";
+    for (size_t i = 1; i < terms; ++i)
+    {
+        code += i % 2 ? " + 1" : " - 2";
+    }
+    auto tokens = Lexer::GetLexer(std::string_view(code))->Tokenize();
+    auto ast = Parser::GetParser(tokens)->GetAbstractSyntaxTree();
+    size_t depth = 0;
+    Syntax *node = ast.get();
+    while (auto binary = dynamic_cast<BinaryExpression *>(node))
+    {
+        CHECK(binary->op.type == (depth % 2 ? '-' : '+'));
+        REQUIRE(dynamic_cast<LiteralValue *>(binary->right.get()) != nullptr);
+        node = binary->left.get();
+        ++depth;
+    }
+    CHECK(depth == terms - 1);
+}
+// lexer arena recording every payload it hands out
+class PayloadArena : public std::pmr::memory_resource
+{
+  public:
+    std::vector<const char *> payloads;
+
+  private:
+    std::pmr::monotonic_buffer_resource storage;
+
+    void *do_allocate(size_t size, size_t alignment) override
+    {
+        auto payload = storage.allocate(size, alignment);
+        payloads.push_back(static_cast<const char *>(payload));
+        return payload;
+    }
+
+    void do_deallocate(void *, size_t, size_t) override
+    {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+class TextVisitor : public Visitor
+{
+  public:
+    std::vector<const char *> texts;
+
+    void Visit(BinaryExpression *syntax, std::any &data) override
+    {
+        syntax->left->Visit(this, data);
+        syntax->right->Visit(this, data);
+    }
+
+    void Visit(LiteralValue *syntax, std::any &) override
+    {
+        texts.push_back(syntax->value.str().data());
+    }
+};
+
+TEST_CASE("Parser-NoPayloadCopy", "[core][parser]")
+{
+    // escaped strings are the payloads that need storage, the lexer allocates each once
+    // and the tree must view those very bytes
+    std::string code;
+    for (int i = 0; i < 64; ++i)
+    {
+        code += (i ? " + \"text\\t" : "\"text\\t") + std::to_string(i) + "\"";
+    }
+    auto arena = std::make_shared<PayloadArena>();
+    LexerOptions options;
+    options.arena = arena;
+    auto lexer = Lexer::GetLexer(std::string_view(code), options);
+    auto ast = Parser::GetParser(lexer)->GetAbstractSyntaxTree();
+    TextVisitor visitor;
+    std::any data;
+    ast->Visit(&visitor, data);
+    CHECK(arena->payloads.size() == 64);
+    CHECK(visitor.texts == arena->payloads);
+}
+
+TEST_CASE("Parser-Recovery", "[core][parser]")
+{
+    const std::string code = "1 + ;\n2 * 3\n4 5 6\n) + 7; 8\n1 +\n+ 2 }\n9 +";
+    const std::vector<std::pair<uint32_t, std::string>> expected = {
+        {4, "expect expression but got ';' at line:1 column:5"},
+        {14, "expect end of statement but got number at line:3 column:3"},
+        {18, "expect expression but got ')' at line:4 column:1"},
+        {31, "expect expression but got '+' at line:6 column:1"},
+        {static_cast<uint32_t>(code.size()), "expect expression at <eof>"},
+    };
+    // a stream tokenized from an istream has no source to locate diagnostics in
+    auto check = [&expected](Parser &parser, bool located = true) {
+        std::vector<std::list<int>> statements;
+        while (auto ast = parser.GetAbstractSyntaxTree())
+        {
+            std::any data = &statements.emplace_back();
+            TestVisitor visitor;
+            ast->Visit(&visitor, data);
+        }
+        CHECK(statements == std::vector<std::list<int>>{{1, 0, 0}, {0}});
+        auto &diagnostics = parser.GetDiagnostics();
+        REQUIRE(diagnostics.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            CHECK(diagnostics[i].offset == expected[i].first);
+            auto message = expected[i].second;
+            auto at = message.find(" at line:");
+            if (!located && at != std::string::npos)
+            {
+                message = message.substr(0, at) + " at <unknown location>";
+            }
+            CHECK(diagnostics[i].message == message);
+        }
+    };
+    SECTION("Lexer")
+    {
+        auto lexer = Lexer::GetLexer(std::string_view(code));
+        check(*Parser::GetParser(lexer, ErrorMode::Collect));
+    }
+    SECTION("TokenStream")
+    {
+        auto tokens = Lexer::GetLexer(std::string_view(code))->Tokenize();
+        check(*Parser::GetParser(tokens, ErrorMode::Collect));
+    }
+    SECTION("StreamingLexer")
+    {
+        for (size_t chunk : {1, 16})
+        {
+            INFO("chunk " << chunk);
+            std::istringstream input(code);
+            auto lexer = Lexer::GetStreamingLexer(input, chunk);
+            check(*Parser::GetParser(lexer, ErrorMode::Collect));
+        }
+    }
+    SECTION("StreamingTokenStream")
+    {
+        std::istringstream input(code);
+        auto tokens = Lexer::GetStreamingLexer(input, 16)->Tokenize();
+        check(*Parser::GetParser(tokens, ErrorMode::Collect), false);
+    }
+    SECTION("EmptyStream")
+    {
+        // a default constructed stream reads as the end of input
+        TokenStream tokens;
+        auto parser = Parser::GetParser(tokens, ErrorMode::Collect);
+        CHECK_FALSE(parser->GetAbstractSyntaxTree());
+        CHECK(parser->GetDiagnostics().empty());
+    }
+    SECTION("Lines")
+    {
+        // statements end at line breaks without asking where the tokens are
+        std::string lines;
+        for (int i = 0; i < 200; ++i)
+        {
+            lines += "1 + 2\n";
+        }
+        std::istringstream input(lines);
+        auto lexer = Lexer::GetStreamingLexer(input, 16);
+        auto parser = Parser::GetParser(lexer);
+        size_t count = 0;
+        while (parser->GetAbstractSyntaxTree())
+        {
+            ++count;
+        }
+        CHECK(count == 200);
+        for (auto errors : {ErrorMode::Throw, ErrorMode::Collect})
+        {
+            std::istringstream two("1\n2");
+            auto tokens = Lexer::GetStreamingLexer(two, 16)->Tokenize();
+            parser = Parser::GetParser(tokens, errors);
+            CHECK(parser->GetAbstractSyntaxTree());
+            CHECK(parser->GetAbstractSyntaxTree());
+            CHECK_FALSE(parser->GetAbstractSyntaxTree());
+            CHECK(parser->GetDiagnostics().empty());
+        }
+    }
+    SECTION("Throw")
+    {
+        auto lexer = Lexer::GetLexer(std::string_view(code));
+        auto parser = Parser::GetParser(lexer);
+        CHECK_THROWS_MATCHES(parser->GetAbstractSyntaxTree(), Exception, WhatEquals(expected[0].second));
+    }
+    SECTION("LexerErrors")
+    {
+        // malformed tokens are reported by the lexer only
+        LexerOptions options;
+        options.errors = ErrorMode::Collect;
+        auto lexer = Lexer::GetLexer(std::string_view("1 + 12u7;\n2"), options);
+        auto parser = Parser::GetParser(lexer, ErrorMode::Collect);
+        auto ast = parser->GetAbstractSyntaxTree();
+        REQUIRE(dynamic_cast<LiteralValue *>(ast.get()) != nullptr);
+        CHECK(parser->GetDiagnostics().empty());
+        CHECK(lexer->GetDiagnostics().size() == 1);
+        CHECK_FALSE(parser->GetAbstractSyntaxTree());
+    }
+}
+
+TEST_CASE("Parser-StreamingStrings", "[core][parser][stream]")
+{
+    // the parser keeps tokens while the lexer refills its window, literals must not view it
+    std::istringstream input("\"hello\" + \"wo\\trld\" + R\"(again)\"");
+    auto lexer = Lexer::GetStreamingLexer(input, 4);
+    auto ast = Parser::GetParser(lexer)->GetAbstractSyntaxTree();
+    auto outer = dynamic_cast<BinaryExpression *>(ast.get());
+    REQUIRE(outer != nullptr);
+    auto inner = dynamic_cast<BinaryExpression *>(outer->left.get());
+    REQUIRE(inner != nullptr);
+    CHECK(static_cast<LiteralValue *>(inner->left.get())->value.str() == "hello");
+    CHECK(static_cast<LiteralValue *>(inner->right.get())->value.str() == "wo\trld");
+    CHECK(static_cast<LiteralValue *>(outer->right.get())->value.str() == "again");
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include <random>
+#include <string>
+#include <vector>
+#include "catch2_ext.hpp"
+#include "scan.hpp"
+using namespace cd;
+using namespace script;
+
+TEST_CASE("Scan-SkipBlank", "[core][scan]")
+{
+    for (const auto &variant : scan::Variants())
+    {
+        INFO("variant " << variant.name);
+        for (size_t length = 0; length < 100; ++length)
+        {
+            std::string code(length, ' ');
+            for (size_t i = 0; i < length; ++i)
+            {
+                code[i] = " \t\v\f"[i % 4];
+            }
+            code.push_back('\0');
+            code.push_back('x');
+            code.append(40, ' ');
+            const char *begin = code.data();
+            CHECK(variant.skip_blank(begin, begin + code.size()) - begin == static_cast<std::ptrdiff_t>(length + 1));
+            CHECK(variant.skip_blank(begin, begin + length) - begin == static_cast<std::ptrdiff_t>(length));
+        }
+    }
+}
+
+TEST_CASE("Scan-FindFirstOf", "[core][scan]")
+{
+    for (const auto &variant : scan::Variants())
+    {
+        INFO("variant " << variant.name);
+        for (size_t length = 0; length < 100; ++length)
+        {
+            std::string code(length, 'a');
+            code.append("*\r\n");
+            code.append(40, 'b');
+            const char *begin = code.data();
+            const char *end = begin + code.size();
+            CHECK(variant.find_first_of(begin, end, '\r', '\n', '\n', '\n') - begin == static_cast<std::ptrdiff_t>(length + 1));
+            CHECK(variant.find_first_of(begin, end, '*', '\r', '\n', '\n') - begin == static_cast<std::ptrdiff_t>(length));
+            CHECK(variant.find_first_of(begin, end, 'c', 'd', 'd', 'd') == end);
+            CHECK(variant.find_first_of(begin + length + 3, end, 'b', 'b', 'b', 'b') - begin == static_cast<std::ptrdiff_t>(length + 3));
+        }
+    }
+}
+
+TEST_CASE("Scan-Variants", "[core][scan]")
+{
+    // the variants a newer cpu skips must still agree with the scalar one
+    auto &variants = scan::Variants();
+    REQUIRE(!variants.empty());
+    CHECK(std::string(variants.front().name) == "scalar");
+    const auto &scalar = variants.front();
+    std::mt19937 random(7);
+    for (int round = 0; round < 20000; ++round)
+    {
+        // few distinct bytes, so stops land anywhere in and across the blocks
+        std::string text(random() % 200, ' ');
+        for (auto &ch : text)
+        {
+            ch = " \t\0\v\fa*\n\r\x80\xFF"[random() % 11];
+        }
+        size_t from = random() % (text.size() + 1);
+        const char *begin = text.data() + from;
+        const char *end = begin + random() % (text.size() - from + 1);
+        INFO("text " << text << " from " << from << " size " << end - begin);
+        for (const auto &variant : variants)
+        {
+            INFO("variant " << variant.name);
+            CHECK(variant.skip_blank(begin, end) == scalar.skip_blank(begin, end));
+            CHECK(variant.find_first_of(begin, end, '*', '\n', '\r', 'a') == scalar.find_first_of(begin, end, '*', '\n', '\r', 'a'));
+            CHECK(variant.find_first_of(begin, end, '\x80', '\xFF', '\0', '\t') == scalar.find_first_of(begin, end, '\x80', '\xFF', '\0', '\t'));
+        }
+    }
+}
+
+// position of the first invalid sequence, decoding code points the long way
+static size_t FirstInvalidUtf8(const std::string &text)
+{
+    size_t i = 0;
+    while (i < text.size())
+    {
+        auto lead = static_cast<uint8_t>(text[i]);
+        size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        if (length == 0 || i + length > text.size())
+        {
+            return i;
+        }
+        uint32_t point = length == 1 ? lead : lead & (0x7F >> length);
+        for (size_t k = 1; k < length; ++k)
+        {
+            auto byte = static_cast<uint8_t>(text[i + k]);
+            if ((byte & 0xC0) != 0x80)
+            {
+                return i;
+            }
+            point = (point << 6) | (byte & 0x3F);
+        }
+        static const uint32_t smallest[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (point < smallest[length] || point > 0x10FFFF || (point >= 0xD800 && point <= 0xDFFF))
+        {
+            return i;
+        }
+        i += length;
+    }
+    return text.size();
+}
+
+TEST_CASE("Scan-ValidateUtf8", "[core][scan]")
+{
+    const std::vector<std::string> pieces = {
+        "a", "plain ascii text ", "\xC3\xA9", "\xE4\xB8\xAD\xE6\x96\x87", "\xF0\x9F\x98\x80", "\xEF\xBF\xBF", "\xF4\x8F\xBF\xBF", "\xED\x9F\xBF",
+        // invalid: stray continuation, overlong, surrogate, past U+10FFFF, bad lead, truncated
+        "\x80", "\xC0\xAF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xF8", "\xE4\xB8", "\xF0\x9F\x98",
+    };
+    std::mt19937 random(42);
+    for (int round = 0; round < 20000; ++round)
+    {
+        std::string text;
+        size_t size = random() % 160;
+        while (text.size() < size)
+        {
+            // mostly valid pieces, so errors land anywhere in the block
+            text += pieces[random() % 100 < 97 ? random() % 8 : random() % pieces.size()];
+        }
+        if (random() % 4 == 0)
+        {
+            text.resize(random() % (text.size() + 1));
+        }
+        INFO("text " << text);
+        const char *begin = text.data();
+        auto expected = static_cast<std::ptrdiff_t>(FirstInvalidUtf8(text));
+        for (const auto &variant : scan::Variants())
+        {
+            INFO("variant " << variant.name);
+            CHECK(variant.validate_utf8(begin, begin + text.size()) - begin == expected);
+        }
+    }
+    for (const auto &variant : scan::Variants())
+    {
+        INFO("variant " << variant.name);
+        for (int ch = 0; ch < 256; ++ch)
+        {
+            // every byte value at the edges of the 16 and 32 byte blocks
+            for (size_t at : {0, 15, 16, 31, 33})
+            {
+                std::string text(40, 'x');
+                text[at] = static_cast<char>(ch);
+                CHECK(variant.validate_utf8(text.data(), text.data() + text.size()) - text.data() == static_cast<std::ptrdiff_t>(FirstInvalidUtf8(text)));
+            }
+        }
+    }
+}
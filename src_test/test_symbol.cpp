@@ -0,0 +1,116 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "catch2_ext.hpp"
+#include "lexer.hpp"
+#include "symbol.hpp"
+using namespace cd;
+using namespace script;
+
+TEST_CASE("SymbolTable-Intern", "[core][symbol]")
+{
+    SymbolTable symbols;
+    auto a = symbols.Intern("alpha");
+    auto b = symbols.Intern("beta");
+    CHECK(a != b);
+    CHECK(symbols.Intern(std::string("alpha")) == a);
+    CHECK(symbols.Name(a) == "alpha");
+    CHECK(symbols.Name(b) == "beta");
+    CHECK(symbols.Find("beta") == b);
+    CHECK(symbols.Find("gamma") == SymbolTable::npos);
+    CHECK(symbols.size() == 2);
+
+    std::string longname(20000, 'x');
+    auto c = symbols.Intern(longname);
+    CHECK(symbols.Name(c) == longname);
+    CHECK(symbols.Name(a) == "alpha");
+}
+
+TEST_CASE("Lexer-Identifier-Symbol", "[core][lexer][symbol]")
+{
+    {
+        std::istringstream code("foo bar foo");
+        auto lexer = Lexer::GetLexer(code);
+        auto foo = lexer->GetToken();
+        auto bar = lexer->GetToken();
+        auto again = lexer->GetToken();
+        CHECK(foo.symbol() == again.symbol());
+        CHECK(foo.symbol() != bar.symbol());
+        CHECK(foo.str().data() == again.str().data());
+        CHECK(lexer->GetSymbolTable().Name(bar.symbol()) == "bar");
+    }
+    {
+        LexerOptions options;
+        options.symbols = std::make_shared<SymbolTable>();
+        auto first = Lexer::GetLexer(std::string_view("shared"), options);
+        auto second = Lexer::GetLexer(std::string_view("other shared"), options);
+        auto token = first->GetToken();
+        CHECK(second->GetToken().symbol() != token.symbol());
+        CHECK(second->GetToken().symbol() == token.symbol());
+        CHECK(options.symbols->size() == 2);
+    }
+}
+
+// upstream of the arena, tracks how many bytes the arena holds
+class CountingResource : public std::pmr::memory_resource
+{
+  public:
+    size_t bytes = 0;
+
+  private:
+    void *do_allocate(size_t size, size_t alignment) override
+    {
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+
+    void do_deallocate(void *p, size_t size, size_t alignment) override
+    {
+        bytes -= size;
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+TEST_CASE("Lexer-Arena", "[core][lexer][symbol]")
+{
+    CountingResource upstream;
+    LexerOptions options;
+    options.arena = std::make_shared<std::pmr::monotonic_buffer_resource>(&upstream);
+    SECTION("GetToken")
+    {
+        Token name, text;
+        {
+            auto lexer = Lexer::GetLexer(std::string_view("name = \"a\\tb\";"), options);
+            name = lexer->GetToken();
+            (void)lexer->GetToken();
+            text = lexer->GetToken();
+        }
+        // payloads outlive the lexer and its symbol table
+        CHECK(upstream.bytes > 0);
+        CHECK(name.str() == "name");
+        CHECK(text.str() == "a\tb");
+    }
+    SECTION("Tokenize")
+    {
+        std::string code;
+        while (code.size() < 512 * 1024)
+        {
+            code += "value = \"escaped\\ttext\" .. other;\n";
+        }
+        options.threads = 4;
+        auto stream = Lexer::GetLexer(std::string_view(code), options)->Tokenize();
+        REQUIRE(stream[2].type == Token::String);
+        CHECK(stream[2].str() == "escaped\ttext");
+        CHECK(stream[stream.size() - 5].str() == "escaped\ttext");
+        CHECK(stream[stream.size() - 3].str() == "other");
+    }
+    options.arena.reset();
+    CHECK(upstream.bytes == 0);
+}
@@ -0,0 +1,197 @@
+// Copyright (c) 2019 chendi
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#include "catch2_ext.hpp"
+#include "lexer.hpp"
+using namespace cd;
+using namespace script;
+
+TEST_CASE("Lexer-Tokenize", "[core][lexer][stream]")
+{
+    {
+        std::string_view code("abc = 1.5 + \"s\\t\" // tail\nabc");
+        auto lexer = Lexer::GetLexer(code);
+        auto stream = lexer->Tokenize();
+        REQUIRE(stream.size() == 8);
+        CHECK(stream.types == std::vector<token_t>{Token::Identifier, '=', Token::Number, '+', Token::String, Token::Comment, Token::Identifier, Token::EndOfFile});
+        CHECK(stream.offsets == std::vector<uint32_t>{0, 4, 6, 10, 12, 18, 26, 29});
+        CHECK(stream.newlines == std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 1, 0});
+        CHECK(stream[0].str() == "abc");
+        CHECK(stream[0].symbol() == stream[6].symbol());
+        CHECK(stream.payloads[0] == stream.payloads[6]);
+        CHECK(stream[2].number().get<double>() == 1.5);
+        CHECK(stream[4].str() == "s\t");
+        CHECK(stream[5].str() == " tail");
+        CHECK(stream.numbers.size() == 1);
+        CHECK(stream.texts.size() == 2);
+    }
+    {
+        std::istringstream code("");
+        auto lexer = Lexer::GetLexer(code);
+        auto stream = lexer->Tokenize();
+        CHECK(stream.types == std::vector<token_t>{Token::EndOfFile});
+        CHECK(stream.offsets == std::vector<uint32_t>{0});
+    }
+    {
+        std::istringstream code("a b c");
+        auto lexer = Lexer::GetLexer(code);
+        CHECK(lexer->GetToken().str() == "a");
+        auto stream = lexer->Tokenize();
+        CHECK(stream.types == std::vector<token_t>{Token::Identifier, Token::Identifier, Token::EndOfFile});
+        CHECK(stream.offsets == std::vector<uint32_t>{2, 4, 5});
+    }
+    {
+        // escaped text outlives the lexer even when only the symbol table is shared
+        std::string_view code("\"tab\\there\" // tail");
+        auto symbols = std::make_shared<SymbolTable>();
+        auto stream = Lexer::GetLexer(code, {symbols})->Tokenize();
+        REQUIRE(stream.size() == 3);
+        CHECK(stream[0].str() == "tab\there");
+        CHECK(stream[1].str() == " tail");
+    }
+}
+
+static void CheckSameStream(const TokenStream &stream, const TokenStream &expected)
+{
+    REQUIRE(stream.types == expected.types);
+    CHECK(stream.offsets == expected.offsets);
+    CHECK(stream.newlines == expected.newlines);
+    CHECK(stream.payloads == expected.payloads);
+    CHECK(stream.texts == expected.texts);
+    REQUIRE(stream.numbers.size() == expected.numbers.size());
+    for (size_t i = 0; i < stream.numbers.size(); ++i)
+    {
+        CHECK(stream.numbers[i].type == expected.numbers[i].type);
+    }
+}
+
+TEST_CASE("Lexer-Tokenize-Edit", "[core][lexer][stream]")
+{
+    {
+        std::string code = "abc = \"\\n\" 1.5\n";
+        auto symbols = std::make_shared<SymbolTable>();
+        auto origin = Lexer::GetLexer(code, {symbols});
+        auto previous = origin->Tokenize();
+        std::string edited = "abcd = \"\\n\" 1.5\n";
+        auto lexer = Lexer::GetLexer(edited, {symbols});
+        auto stream = lexer->Tokenize(previous, {3, 0, 1});
+        origin.reset();
+        code.clear();
+        CHECK(stream.types == std::vector<token_t>{Token::Identifier, '=', Token::String, Token::Number, Token::EndOfFile});
+        CHECK(stream.offsets == std::vector<uint32_t>{0, 5, 7, 12, 16});
+        CHECK(stream[0].str() == "abcd");
+        CHECK(stream[2].str() == "\n");
+        CHECK(stream.source.data() == edited.data());
+    }
+    {
+        std::string code = "x";
+        auto previous = Lexer::GetLexer(code)->Tokenize();
+        auto lexer = Lexer::GetLexer(code);
+        CHECK_THROWS_MATCHES(lexer->Tokenize(previous, {0, 0, 0}), Exception, WhatEquals("token stream was lexed with another symbol table"));
+        lexer = Lexer::GetLexer(code, {previous.symbols});
+        CHECK_THROWS_MATCHES(lexer->Tokenize(previous, {0, 0, 1}), Exception, WhatEquals("edit does not match the token stream"));
+    }
+    {
+        // every single edit of a small program must give the same tokens as lexing it from scratch
+        const std::string code = "a = \"s\\t\" + 0x1F /* c\n */ 1'0\r\nif (x <= 1) { f(R\"(r)\", ...) } // t\n0b101 /* e */ /* f */ g";
+        const std::vector<std::pair<uint32_t, std::string>> edits = {{0, "x"}, {0, " "}, {0, "\""}, {0, "1"}, {0, "/*"}, {1, ""}, {2, ""}, {2, "+1"}, {3, "\n"}, {0, "\n"}};
+        auto symbols = std::make_shared<SymbolTable>();
+        auto origin = Lexer::GetLexer(code, {symbols});
+        auto previous = origin->Tokenize();
+        size_t checked = 0;
+        for (uint32_t offset = 0; offset <= code.size(); ++offset)
+        {
+            for (auto &[removed, inserted] : edits)
+            {
+                if (offset + removed > code.size())
+                {
+                    continue;
+                }
+                std::string edited = code.substr(0, offset) + inserted + code.substr(offset + removed);
+                auto fresh = Lexer::GetLexer(edited, {symbols});
+                TokenStream expected;
+                try
+                {
+                    expected = fresh->Tokenize();
+                }
+                catch (const Exception &)
+                {
+                    continue;
+                }
+                INFO("offset " << offset << " removed " << removed << " inserted " << inserted);
+                auto lexer = Lexer::GetLexer(edited, {symbols});
+                auto stream = lexer->Tokenize(previous, {offset, removed, static_cast<uint32_t>(inserted.size())});
+                CheckSameStream(stream, expected);
+                ++checked;
+            }
+        }
+        CHECK(checked > code.size() * 3);
+    }
+}
+
+TEST_CASE("Lexer-Tokenize-Threads", "[core][lexer][stream]")
+{
+    const std::vector<std::string> pieces = {
+        "/* it's a \"comment\"\n R\"( not raw\n*/\n",
+        "R\"x(raw /* not a comment\n ' \" \n)x\"\n",
+        "abc = \"s\\t\\\"q\" + 0x1F * 1'000 // it's \"tail\n",
+        "if (a <= b) { f(...); }\r\n",
+        "// /* not a block\n",
+        "\n\n    \t\n",
+    };
+    std::string blocked = "/*";
+    for (int i = 0; i < 4000; ++i)
+    {
+        blocked += "don't \"stop\n";
+    }
+    blocked += "*/\n";
+    std::string code;
+    uint32_t seed = 12345;
+    while (code.size() < 1024 * 1024)
+    {
+        seed = seed * 1103515245 + 12345;
+        code += (seed >> 16) % 100 == 0 ? blocked : pieces[(seed >> 16) % pieces.size()];
+    }
+    auto serial = Lexer::GetLexer(code);
+    auto expected = serial->Tokenize();
+    for (unsigned threads : {2, 4, 8, 13})
+    {
+        INFO("threads " << threads);
+        LexerOptions options;
+        options.threads = threads;
+        auto lexer = Lexer::GetLexer(code, options);
+        auto stream = lexer->Tokenize();
+        CheckSameStream(stream, expected);
+        CHECK(lexer->GetToken().type == Token::EndOfFile);
+    }
+    {
+        LexerOptions options;
+        options.threads = 4;
+        auto lexer = Lexer::GetLexer(code, options);
+        CHECK(lexer->GetToken().type == expected.types[0]);
+        auto stream = lexer->Tokenize();
+        CHECK(stream.types == std::vector<token_t>(expected.types.begin() + 1, expected.types.end()));
+        CHECK(stream.offsets == std::vector<uint32_t>(expected.offsets.begin() + 1, expected.offsets.end()));
+    }
+    {
+        // two chunks split inside the first comment and meet the real tokens at the second one
+        std::string half;
+        while (half.size() < 128 * 1024)
+        {
+            half += "abc = 1 + 2\n";
+        }
+        const std::string comments = "/* a\n b */ /* c */ x\n";
+        std::string split = half + comments + std::string(half.size() - comments.size() + 1, ' ') + "\n";
+        LexerOptions options;
+        options.threads = 2;
+        CheckSameStream(Lexer::GetLexer(split, options)->Tokenize(), Lexer::GetLexer(split)->Tokenize());
+    }
+    {
+        std::string broken = code + "x = \"open\n" + code;
+        LexerOptions options;
+        options.threads = 8;
+        CHECK_THROWS_MATCHES(Lexer::GetLexer(broken, options)->Tokenize(), Exception, WhatEquals("incomplete string at line:" + std::to_string(Lexer::GetLexer(code)->GetLocation(static_cast<uint32_t>(code.size())).line) + " column:10"));
+    }
+}